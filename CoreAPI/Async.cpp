@@ -0,0 +1,94 @@
+#include "Async.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+
+namespace Silicon {
+
+	/*
+	Completion of a call waited for with wait(). The flag is only set and
+	notified under the lock, so the waiter cannot return and destroy this
+	state before the completing thread is done with it.
+	*/
+	struct _WaitState {
+		std::mutex lock;
+		std::condition_variable completed;
+		bool done = false;
+	};
+
+	CallResult AsyncResult::wait() && {
+		if (!this->handle) {
+			return std::move(this->ready);
+		}
+		_WaitState state;
+		promise_type& promise = this->handle.promise();
+		promise.context = &state;
+		promise.notify = [](void* context) {
+			_WaitState* state = reinterpret_cast<_WaitState*>(context);
+			std::lock_guard<std::mutex> guard(state->lock);
+			state->done = true;
+			state->completed.notify_all();
+		};
+		this->handle.resume();
+		{
+			std::unique_lock<std::mutex> guard(state.lock);
+			state.completed.wait(guard, [&state] {
+				return state.done;
+			});
+		}
+		return this->await_resume();
+	}
+
+	CallableHelper CallableHelper::from_async(asyncfunc func) {
+		if (!func) {
+			return nullptr;
+		}
+		std::shared_ptr<const _AsyncImpl> impl = std::make_shared<_AsyncImpl>(_AsyncImpl{ std::move(func) });
+		CallableHelper helper(vectorfunc([impl](ArgVector args) -> CallResult {
+			return impl->func(args).wait();
+		}));
+		helper.asyncimpl = impl;
+		return helper;
+	}
+	bool CallableHelper::is_async() const {
+		return this->asyncimpl != nullptr;
+	}
+	AsyncResult CallableHelper::async_call(ArgVector args) const {
+		if (this->asyncimpl) {
+			return this->asyncimpl->func(args);
+		}
+		return this->try_vectorcall(args);
+	}
+
+	/*
+	The bound callable may live in a method table, which can be retired
+	while the call is suspended: the coroutine frame keeps its own copy of
+	the callable, and with it the implementation of the call.
+	*/
+	static AsyncResult _bound_async_call(CallableHelper func, ArgVector args) {
+		co_return co_await func.async_call(args);
+	}
+	// same, with self prepended into a buffer owned by the coroutine frame.
+	static AsyncResult _bound_async_call(CallableHelper func, std::vector<Object*> slots, size_t count, KwdNames names) {
+		co_return co_await func.async_call(ArgVector(slots.data() + 1, count, names, true));
+	}
+	AsyncResult BoundCallableHelper::async_call(ArgVector args) const {
+		if (!this->func->is_async()) {
+			return this->try_vectorcall(args);
+		}
+		if (args.has_self_slot()) {
+			return _bound_async_call(*this->func, args.with_self(this->self));
+		}
+		const KwdNames& names = args.kwd_names();
+		std::vector<Object*> slots(args.size() + 2 + names.size());
+		slots[1] = this->self;
+		for (size_t i = 0; i < args.size(); i++) {
+			slots[i + 2] = args[i];
+		}
+		for (size_t i = 0; i < names.size(); i++) {
+			slots[args.size() + 2 + i] = args.kwd_value(i);
+		}
+		return _bound_async_call(*this->func, std::move(slots), args.size() + 1, names);
+	}
+}
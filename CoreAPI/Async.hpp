@@ -0,0 +1,132 @@
+/*
+Asynchronous native callables, written as C++20 coroutines.
+*/
+#pragma once
+#include "Ref.hpp"
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <functional>
+
+
+namespace Silicon {
+
+	/*
+	Result of an asynchronous native call. Native coroutines return an
+	AsyncResult and co_return a CallResult (or anything convertible to
+	one, such as a Ref<Object> or a CallError).
+	The coroutine only starts when its result is awaited. Awaiting an
+	AsyncResult gives the CallResult of the call. Results of calls that
+	completed synchronously are ready without suspending.
+	*/
+	class AsyncResult {
+	public:
+		struct promise_type;
+
+	private:
+		struct _FinalAwaiter {
+			inline bool await_ready() const noexcept {
+				return false;
+			}
+			inline std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+				promise_type& promise = handle.promise();
+				if (promise.continuation) {
+					return promise.continuation;
+				}
+				if (promise.notify) {
+					// the waiter may destroy the frame as soon as it is notified.
+					void (*notify)(void*) = promise.notify;
+					void* context = promise.context;
+					notify(context);
+				}
+				return std::noop_coroutine();
+			}
+			inline void await_resume() const noexcept {}
+		};
+
+		std::coroutine_handle<promise_type> handle;
+		CallResult ready;
+
+	public:
+		struct promise_type {
+			CallResult result;
+			std::exception_ptr error = nullptr;
+			// resumed upon completion, if the result is awaited.
+			std::coroutine_handle<> continuation = nullptr;
+			// called upon completion otherwise, if the result is waited for with wait().
+			void (*notify)(void*) = nullptr;
+			void* context = nullptr;
+
+			inline AsyncResult get_return_object() {
+				return AsyncResult(std::coroutine_handle<promise_type>::from_promise(*this));
+			}
+			inline std::suspend_always initial_suspend() const noexcept {
+				return {};
+			}
+			inline _FinalAwaiter final_suspend() const noexcept {
+				return {};
+			}
+			inline void return_value(CallResult value) {
+				this->result = std::move(value);
+			}
+			inline void unhandled_exception() {
+				this->error = std::current_exception();
+			}
+		};
+
+		inline explicit AsyncResult(std::coroutine_handle<promise_type> handle) :
+			handle(handle), ready()
+		{}
+		// result of a call that completed synchronously.
+		inline AsyncResult(CallResult ready) :
+			handle(nullptr), ready(std::move(ready))
+		{}
+		inline AsyncResult(AsyncResult&& other) noexcept :
+			handle(other.handle), ready(std::move(other.ready))
+		{
+			other.handle = nullptr;
+		}
+		AsyncResult(const AsyncResult&) = delete;
+		AsyncResult& operator =(const AsyncResult&) = delete;
+
+		inline bool await_ready() const noexcept {
+			return !this->handle;
+		}
+		// start the coroutine, and resume the awaiting one once it completes.
+		inline std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+			this->handle.promise().continuation = awaiting;
+			return this->handle;
+		}
+		/*
+		The result of the call. Exceptions that escaped the coroutine are
+		rethrown here.
+		*/
+		inline CallResult await_resume() {
+			if (!this->handle) {
+				return std::move(this->ready);
+			}
+			if (this->handle.promise().error) {
+				std::rethrow_exception(this->handle.promise().error);
+			}
+			return std::move(this->handle.promise().result);
+		}
+
+		/*
+		Run the call and block the calling thread until it completes.
+		For synchronous callers of asynchronous callables: the coroutine
+		must be resumed by another thread if it suspends.
+		*/
+		CallResult wait() &&;
+
+		inline ~AsyncResult() {
+			if (this->handle) {
+				this->handle.destroy();
+			}
+		}
+	};
+
+	// implementation of the asynchronous entry of a CallableHelper.
+	struct CallableHelper::_AsyncImpl {
+		std::function<AsyncResult(ArgVector)> func;
+	};
+}
@@ -0,0 +1,38 @@
+#include "Batch.hpp"
+#include "../InternalAPI/ThreadPool.hpp"
+
+
+namespace Silicon {
+
+	// make the calls of the tuples in [begin, end), reusing one argument buffer.
+	static void _batch_range(const CallableHelper& func, const std::vector<args_t>& batch, std::vector<CallResult>& results, size_t begin, size_t end) {
+		std::vector<Object*> argv;
+		for (size_t i = begin; i < end; i++) {
+			const args_t& args = batch[i];
+			argv.resize(args.size() + 1);  // with the self slot in front.
+			for (size_t j = 0; j < args.size(); j++) {
+				argv[j + 1] = args[j].get();
+			}
+			results[i] = func.try_vectorcall(ArgVector(argv.data() + 1, args.size(), {}, true));
+		}
+	}
+
+	std::vector<Ref<Object>> batch_call(const CallableHelper& func, const std::vector<args_t>& batch) {
+		std::vector<CallResult> results(batch.size());
+		if (func.is_thread_safe()) {
+			InternalAPI::ThreadPool::shared().parallel_for(batch.size(), [&](size_t begin, size_t end) {
+				_batch_range(func, batch, results, begin, end);
+			});
+		}
+		else {
+			_batch_range(func, batch, results, 0, batch.size());
+		}
+
+		std::vector<Ref<Object>> values;
+		values.reserve(results.size());
+		for (CallResult& result : results) {
+			values.push_back(std::move(result).unwrap());
+		}
+		return values;
+	}
+}
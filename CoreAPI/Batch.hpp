@@ -0,0 +1,17 @@
+#pragma once
+#include "Ref.hpp"
+#include <vector>
+
+
+namespace Silicon {
+
+	/*
+	Call func once for each argument tuple of batch, and return the
+	results in the order of the tuples.
+	If func is declared thread-safe, the calls are spread over the threads
+	of the runtime's pool. Otherwise they are made in order, on the calling
+	thread. Throws a SiliconException for the error of the first failed
+	call once all the calls have returned.
+	*/
+	std::vector<Ref<Object>> batch_call(const CallableHelper& func, const std::vector<args_t>& batch);
+}
@@ -0,0 +1,73 @@
+/*
+Result of native calls, carrying either a value or an error.
+*/
+#pragma once
+#include "Ref.hpp"
+
+
+namespace Silicon {
+
+	/*
+	Error reported by a native call without throwing. Errors are statically
+	allocated and compared by address, so that reporting one costs no more
+	than returning a value.
+	*/
+	struct CallError {
+		const char* message;
+
+		static const CallError wrong_arity;
+		static const CallError wrong_type;
+		static const CallError unexpected_keyword;
+		static const CallError not_callable;
+	};
+
+	/*
+	Return value of the native calling convention. Native functions report
+	errors by returning a CallError rather than by throwing, so that errors
+	propagate through nested calls as plain return values. Exceptions are
+	only thrown by unwrap(), at the boundary of the API.
+	*/
+	class CallResult {
+		Ref<Object> value;
+		const CallError* error;
+
+	public:
+		inline CallResult() :
+			value(), error(nullptr)
+		{}
+		inline CallResult(std::nullptr_t) :
+			CallResult()
+		{}
+		inline CallResult(Ref<Object> value) :
+			value(std::move(value)), error(nullptr)
+		{}
+		inline CallResult(const CallError& error) :
+			value(), error(&error)
+		{}
+
+		inline bool ok() const {
+			return this->error == nullptr;
+		}
+		// the error, or nullptr if the call succeeded.
+		inline const CallError* get_error() const {
+			return this->error;
+		}
+		// the value returned by the call. Empty if the call failed.
+		inline Ref<Object>& get() {
+			return this->value;
+		}
+		inline const Ref<Object>& get() const {
+			return this->value;
+		}
+		/*
+		Return the value of the call, or throw a SiliconException for its
+		error.
+		*/
+		inline Ref<Object> unwrap() && {
+			if (this->error) {
+				throw SiliconException(this->error->message);
+			}
+			return std::move(this->value);
+		}
+	};
+}
@@ -1,104 +1,255 @@
 #include "Ref.hpp"
 #include "CallableHelper.hpp"
+#include "CallResult.hpp"
+#include <algorithm>
+#include <cstring>
 
 namespace Silicon {
+	const CallError CallError::wrong_arity = { "wrong number of arguments." };
+	const CallError CallError::wrong_type = { "wrong argument type." };
+	const CallError CallError::unexpected_keyword = { "unexpected keyword argument." };
+	const CallError CallError::not_callable = { "object is not callable." };
+
+	/*
+	Contiguous array of borrowed argument pointers, with a self slot
+	reserved in front of the arguments. Small argument lists are stored
+	inline, so that building one does not allocate.
+	*/
+	class _ArgBuffer {
+		static constexpr size_t inline_capacity = 8;
+
+		Object* inline_slots[inline_capacity + 1];
+		std::unique_ptr<Object*[]> heap_slots;
+		Object** slots;
+		size_t count;
+
+	public:
+		inline _ArgBuffer(size_t count) :
+			count(count)
+		{
+			if (count <= inline_capacity) {
+				this->slots = this->inline_slots;
+			}
+			else {
+				this->heap_slots = std::unique_ptr<Object*[]>(new Object*[count + 1]);
+				this->slots = this->heap_slots.get();
+			}
+		}
+		inline Object*& operator [](size_t index) {
+			return this->slots[index + 1];
+		}
+		/*
+		View of the buffer, where the last kwnames.size() entries are
+		the values of keyword arguments.
+		*/
+		inline ArgVector view(KwdNames kwnames = {}) {
+			return ArgVector(this->slots + 1, this->count - kwnames.size(), kwnames, true);
+		}
+	};
+
+	/*
+	Gather the names of the keyword arguments in kwds into names, and
+	their values into buffer starting at index 'at'.
+	*/
+	static KwdNames _flatten_kwds(const kwds_t& kwds, std::vector<Object*>& names, _ArgBuffer& buffer, size_t at) {
+		if (kwds.empty()) {
+			return {};
+		}
+		names.reserve(kwds.size());
+		for (auto& [name, value] : kwds) {
+			names.push_back(name.get());
+			buffer[at++] = value.get();
+		}
+		return KwdNames(names.data(), names.size());
+	}
+
+	NativeCallable::NativeCallable() :
+		entry(nullptr), storage(), shared(nullptr)
+	{}
+	NativeCallable::NativeCallable(std::nullptr_t) :
+		NativeCallable()
+	{}
+	NativeCallable::NativeCallable(CallResult (*func)(void*, ArgVector), void* context) :
+		NativeCallable(func ? NativeCallable(_ContextCall{ func, context }) : NativeCallable())
+	{}
+	NativeCallable::NativeCallable(const NativeCallable& other) :
+		entry(other.entry), shared(other.shared)
+	{
+		std::memcpy(this->storage, other.storage, inline_size);
+		if (this->shared) {
+			this->shared->refcnt++;
+		}
+	}
+	NativeCallable::NativeCallable(NativeCallable&& other) noexcept :
+		entry(other.entry), shared(other.shared)
+	{
+		std::memcpy(this->storage, other.storage, inline_size);
+		other.entry = nullptr;
+		other.shared = nullptr;
+	}
+	NativeCallable& NativeCallable::operator=(const NativeCallable& other) {
+		if (other.shared) {
+			other.shared->refcnt++;
+		}
+		if (this->shared && --this->shared->refcnt == 0) {
+			delete this->shared;
+		}
+		this->entry = other.entry;
+		this->shared = other.shared;
+		std::memcpy(this->storage, other.storage, inline_size);
+		return *this;
+	}
+	NativeCallable& NativeCallable::operator=(NativeCallable&& other) noexcept {
+		if (this != &other) {
+			if (this->shared && --this->shared->refcnt == 0) {
+				delete this->shared;
+			}
+			this->entry = other.entry;
+			this->shared = other.shared;
+			std::memcpy(this->storage, other.storage, inline_size);
+			other.entry = nullptr;
+			other.shared = nullptr;
+		}
+		return *this;
+	}
+	CallResult NativeCallable::_ContextCall::operator()(ArgVector args) const {
+		return this->func(this->context, args);
+	}
+	CallResult NativeCallable::_call_shared(const NativeCallable* self, ArgVector args) {
+		return self->shared->call(args);
+	}
+	CallResult NativeCallable::operator()(ArgVector args) const {
+		return this->entry(this, args);
+	}
+	bool NativeCallable::operator==(std::nullptr_t) const {
+		return this->entry == nullptr;
+	}
+	NativeCallable::operator bool() const {
+		return this->entry != nullptr;
+	}
+	NativeCallable::~NativeCallable() {
+		if (this->shared && --this->shared->refcnt == 0) {
+			delete this->shared;
+		}
+	}
+
+	const kwds_t CallableHelper::no_kwds = {};
+
 	CallableHelper::CallableHelper() : 
 		CallableHelper(nullptr) 
 	{}
 	CallableHelper::CallableHelper(functype cfunc) :
-		ftype(true)
+		CallableHelper(cfunc ? vectorfunc([cfunc](ArgVector args) -> Ref<Object> {
+			kwds_t kwds;
+			for (size_t i = 0; i < args.kwd_names().size(); i++) {
+				kwds[args.kwd_names()[i]] = args.kwd_value(i);
+			}
+			return cfunc(args_t(args.begin(), args.end()), kwds);
+		}) : vectorfunc(nullptr))
+	{}
+	CallableHelper::CallableHelper(vectorfunc cfunc) :
+		ftype(true), threadsafe(false)
 	{
-		this->impl.cfunc = cfunc;
+		new (&this->impl.cfunc) vectorfunc(std::move(cfunc));
 	}
 	CallableHelper::CallableHelper(Object* sfunc) :
-		ftype(false)
+		ftype(false), threadsafe(false)
 	{
 		this->impl.sfunc = sfunc;
-		this->impl.sfunc->incRef();
+		Object::_incRef(this->impl.sfunc);
 	}
 	CallableHelper::CallableHelper(std::nullptr_t) :
-		ftype(true)
+		ftype(false), threadsafe(false)
 	{}
 	CallableHelper::CallableHelper(const CallableHelper& other) :
-		ftype(other.ftype)
+		ftype(other.ftype), threadsafe(other.threadsafe), asyncimpl(other.asyncimpl)
 	{
 		if (this->ftype) {
-			this->impl.cfunc = other.impl.cfunc;
+			new (&this->impl.cfunc) vectorfunc(other.impl.cfunc);
 		}
 		else {
 			this->impl.sfunc = other.impl.sfunc;
-			if (this->impl.sfunc)
-				this->impl.sfunc->incRef();
+			Object::_incRef(this->impl.sfunc);
 		}
 	}
 	CallableHelper::CallableHelper(CallableHelper&& other) noexcept :
-		ftype(other.ftype) 
+		ftype(false), threadsafe(false)
 	{
-		if (this->ftype) {
-			this->impl.cfunc = other.impl.cfunc;
-			other.impl.cfunc = nullptr;
+		this->_take(std::move(other));
+	}
+	CallableHelper& CallableHelper::operator=(const CallableHelper& other) {
+		if (this != &other) {
+			CallableHelper copy(other);
+			this->_release();
+			this->_take(std::move(copy));
 		}
-		else {
-			this->impl.sfunc = other.impl.sfunc;
-			other.impl.sfunc = nullptr;
+		return *this;
+	}
+	CallableHelper& CallableHelper::operator=(CallableHelper&& other) noexcept {
+		if (this != &other) {
+			this->_release();
+			this->_take(std::move(other));
 		}
+		return *this;
 	}
-	CallableHelper& CallableHelper::operator=(const CallableHelper& other) {
+	// take over the target of other, which is left empty. Requires this to be empty.
+	void CallableHelper::_take(CallableHelper&& other) {
 		this->ftype = other.ftype;
+		this->threadsafe = other.threadsafe;
+		this->asyncimpl = std::move(other.asyncimpl);
 		if (this->ftype) {
-			this->impl.cfunc = other.impl.cfunc;
+			new (&this->impl.cfunc) vectorfunc(std::move(other.impl.cfunc));
 		}
 		else {
-			auto tmp = this->impl.sfunc;
 			this->impl.sfunc = other.impl.sfunc;
-			if (this->impl.sfunc)
-				this->impl.sfunc->incRef();
-			if (tmp)
-				tmp->decRef();
+			other.impl.sfunc = nullptr;
 		}
-		return *this;
+		other._release();
 	}
-	CallableHelper& CallableHelper::operator=(CallableHelper&& other) noexcept {
-		Object* tmp = nullptr;
-
-		if (!this->ftype) {
-			tmp = this->impl.sfunc;
-		}
-		this->ftype = other.ftype;
+	void CallableHelper::_release() {
 		if (this->ftype) {
-			this->impl.cfunc = other.impl.cfunc;
+			this->impl.cfunc.~vectorfunc();
 		}
 		else {
-			this->impl.sfunc = other.impl.sfunc;
-			this->impl.sfunc->incRef();
+			Object::_decRef(this->impl.sfunc);
 		}
-		if (tmp)
-			tmp->decRef();
-		return *this;
+		this->ftype = false;
+		this->threadsafe = false;
+		this->asyncimpl = nullptr;
+		this->impl.sfunc = nullptr;
 	}
-	Ref<Object> CallableHelper::operator()(args_t args, kwds_t kwds) const {
+	Ref<Object> CallableHelper::operator()(const args_t& args, const kwds_t& kwds) const {
+		_ArgBuffer buffer(args.size() + kwds.size());
+		for (size_t i = 0; i < args.size(); i++) {
+			buffer[i] = args[i].get();
+		}
+		std::vector<Object*> names;
+		return this->vectorcall(buffer.view(_flatten_kwds(kwds, names, buffer, args.size())));
+	}
+	Ref<Object> CallableHelper::vectorcall(ArgVector args) const {
+		return this->try_vectorcall(args).unwrap();
+	}
+	CallResult CallableHelper::try_vectorcall(ArgVector args) const {
 		if (this->ftype) {
-			try {
-				return this->impl.cfunc(args, kwds);
-			} catch (SiliconException& exc) {
-				exc;
-				throw;
-			}
-			catch (std::exception& exc) {
-				exc;
-				// throw SiliconException(new CppException(exc.what());
-				throw;
-			}
-			catch (...) {
-				// throw SiliconException(new ExternalException());
-				throw;
-			}
+			return this->impl.cfunc(args);
 		}
-		BoundCallableHelper call_impl;
-		if (!this->impl.sfunc->getType()->get_method("operator ()", this->impl.sfunc, &call_impl)) {
-			return nullptr;
+		if (this->impl.sfunc == nullptr) {
+			return CallError::not_callable;
+		}
+		Type* type = type_of(this->impl.sfunc);
+		_DispatchGuard guard(type);
+		const CallableHelper* call_impl;
+		if (!type->_find_method("operator ()", &Type::sealed_call_impl, &call_impl)) {
+			return CallError::not_callable;
 		}
-		return call_impl(args, kwds);
+		return call_impl->bind(this->impl.sfunc).try_vectorcall(args);
+	}
+	CallableHelper& CallableHelper::set_thread_safe(bool threadsafe) {
+		this->threadsafe = threadsafe;
+		return *this;
+	}
+	bool CallableHelper::is_thread_safe() const {
+		return this->threadsafe;
 	}
 	bool CallableHelper::operator==(std::nullptr_t) const {
 		if (this->ftype) {
@@ -112,7 +263,8 @@ namespace Silicon {
 	BoundCallableHelper CallableHelper::bind(Object* self) const {
 		return BoundCallableHelper(const_cast<CallableHelper&>(*this), self);
 	}
-	bool CallableHelper::typeCheckArgs(args_t args, argtypes_t types, Ref<Object>* exception) {
+	template<class TArgs>
+	static bool _typeCheckArgs(const TArgs& args, const argtypes_t& types, Ref<Object>* exception) {
 		*exception = nullptr;
 		if (types.size() != args.size()) {
 			return false;
@@ -134,26 +286,49 @@ namespace Silicon {
 		}
 		return true;
 	}
-	bool CallableHelper::typeCheckKwds(kwds_t kwds, kwdtypes_t types, Ref<Object>* exception) {
+	bool CallableHelper::typeCheckArgs(const args_t& args, const argtypes_t& types, Ref<Object>* exception) {
+		return _typeCheckArgs(args, types, exception);
+	}
+	bool CallableHelper::typeCheckArgs(ArgVector args, const argtypes_t& types, Ref<Object>* exception) {
+		return _typeCheckArgs(args, types, exception);
+	}
+	static bool _typeCheckKwd(const kwdtypes_t& types, const Ref<Object>& name, Object* value) {
+		auto found = types.find(name);
+		if (found == types.end()) {
+			return false;
+		}
+		if (found->second == nullptr) {
+			return true;
+		}
+		if (value == nullptr) {
+			return false;
+		}
+		if (!typeof<Type>->instance_check(found->second)) {
+			throw SiliconException(nullptr);
+		}
+		Ref<Type> tp = found->second;
+		return tp->instance_check(value);
+	}
+	bool CallableHelper::typeCheckKwds(const kwds_t& kwds, const kwdtypes_t& types, Ref<Object>* exception) {
 		*exception = nullptr;
 		if (kwds.size() != types.size()) {
 			return false;
 		}
 		for (auto& [k, v] : kwds) {
-			if (!types.contains(k)) {
-				return false;
-			}
-			if (types[k] == nullptr) {
-				continue;
-			}
-			if (v == nullptr) {
+			if (!_typeCheckKwd(types, k, v.get())) {
 				return false;
 			}
-			if (!typeof<Type>->instance_check(types[k])) {
-				throw SiliconException(nullptr);
-			}
-			auto tp = types[k].DownCast<Type>();
-			if (!tp->instance_check(v)) {
+		}
+		return true;
+	}
+	bool CallableHelper::typeCheckKwds(ArgVector args, const kwdtypes_t& types, Ref<Object>* exception) {
+		*exception = nullptr;
+		const KwdNames& names = args.kwd_names();
+		if (names.size() != types.size()) {
+			return false;
+		}
+		for (size_t i = 0; i < names.size(); i++) {
+			if (!_typeCheckKwd(types, names[i], args.kwd_value(i))) {
 				return false;
 			}
 		}
@@ -161,10 +336,7 @@ namespace Silicon {
 	}
 
 	CallableHelper::~CallableHelper() {
-		if (!this->ftype && this->impl.sfunc) {
-			this->impl.sfunc->decRef();
-			this->impl.sfunc = nullptr;
-		}
+		this->_release();
 	}
 
 	BoundCallableHelper::BoundCallableHelper() :
@@ -174,38 +346,132 @@ namespace Silicon {
 	BoundCallableHelper::BoundCallableHelper(CallableHelper& func, Object* self) :
 		func(&func), self(self)
 	{
-		if (this->self) {
-			this->self->incRef();
-		}
+		Object::_incRef(this->self);
 	}
 	BoundCallableHelper::BoundCallableHelper(const BoundCallableHelper& other) :
 		func(other.func), self(other.self)
 	{
-		if (this->self) {
-			this->self->incRef();
-		}
+		Object::_incRef(this->self);
 	}
 	BoundCallableHelper& BoundCallableHelper::operator=(const BoundCallableHelper& other) {
 		Object* old = this->self;
 		this->func = other.func;
 		this->self = other.self;
-		if (this->self) {
-			this->self->incRef();
+		Object::_incRef(this->self);
+		Object::_decRef(old);
+		return *this;
+	}
+	Ref<Object> BoundCallableHelper::operator()(const args_t& args, const kwds_t& kwds) const {
+		_ArgBuffer buffer(args.size() + 1 + kwds.size());
+		buffer[0] = this->self;
+		for (size_t i = 0; i < args.size(); i++) {
+			buffer[i + 1] = args[i].get();
 		}
-		if (old) {
-			old->decRef();
+		std::vector<Object*> names;
+		return this->func->vectorcall(buffer.view(_flatten_kwds(kwds, names, buffer, args.size() + 1)));
+	}
+	Ref<Object> BoundCallableHelper::vectorcall(ArgVector args) const {
+		return this->try_vectorcall(args).unwrap();
+	}
+	CallResult BoundCallableHelper::try_vectorcall(ArgVector args) const {
+		if (args.has_self_slot()) {
+			return this->func->try_vectorcall(args.with_self(this->self));
 		}
-		return *this;
+		const KwdNames& names = args.kwd_names();
+		_ArgBuffer buffer(args.size() + 1 + names.size());
+		buffer[0] = this->self;
+		for (size_t i = 0; i < args.size(); i++) {
+			buffer[i + 1] = args[i];
+		}
+		for (size_t i = 0; i < names.size(); i++) {
+			buffer[args.size() + 1 + i] = args.kwd_value(i);
+		}
+		return this->func->try_vectorcall(buffer.view(names));
 	}
-	Ref<Object> BoundCallableHelper::operator()(args_t args, kwds_t kwds) const {
-		args.insert(args.begin(), this->self);
-		return this->func->operator()(args, kwds);
+	bool BoundCallableHelper::is_thread_safe() const {
+		return this->func && this->func->is_thread_safe();
 	}
 	BoundCallableHelper::~BoundCallableHelper() {
-		if (this->self) {
-			this->self->decRef();
-			this->self = nullptr;
+		Object::_decRef(this->self);
+		this->self = nullptr;
+	}
+
+	/*
+	Parameter index of each keyword of a call, for one sequence of
+	keyword names. Published matches are immutable.
+	*/
+	struct KwdMatcher::_Match {
+		std::vector<Object*> names;
+		std::vector<size_t> indices;
+		bool valid;
+
+		inline bool matches(const KwdNames& other) const {
+			if (other.size() != this->names.size()) {
+				return false;
+			}
+			for (size_t i = 0; i < other.size(); i++) {
+				if (other[i] != this->names[i]) {
+					return false;
+				}
+			}
+			return true;
 		}
+	};
+
+	KwdMatcher::KwdMatcher(args_t params) :
+		params(params), cached(nullptr)
+	{}
+	size_t KwdMatcher::size() const {
+		return this->params.size();
+	}
+	const KwdMatcher::_Match* KwdMatcher::_get_match(const KwdNames& names) const {
+		const _Match* match = this->cached.load();
+		if (match && match->matches(names)) {
+			return match;
+		}
+
+		_Match* computed = new _Match();
+		computed->valid = true;
+		for (size_t i = 0; i < names.size(); i++) {
+			Object* name = names[i];
+			auto found = std::find_if(this->params.begin(), this->params.end(), [name](const Ref<Object>& param) {
+				return param.get() == name;
+			});
+			computed->names.push_back(name);
+			computed->indices.push_back(found - this->params.begin());
+			computed->valid &= found != this->params.end();
+		}
+
+		// other threads may still be matching against the previous entry.
+		const _Match* old = this->cached.exchange(computed);
+		if (old) {
+			InternalAPI::retire(const_cast<_Match*>(old), [](void* match) {
+				delete reinterpret_cast<_Match*>(match);
+			});
+		}
+		return computed;
+	}
+	bool KwdMatcher::match(ArgVector args, Object** out) const {
+		for (size_t i = 0; i < this->params.size(); i++) {
+			out[i] = nullptr;
+		}
+		const KwdNames& names = args.kwd_names();
+		if (names.size() == 0) {
+			return true;
+		}
+
+		InternalAPI::EpochGuard guard;
+		const _Match* match = this->_get_match(names);
+		if (!match->valid) {
+			return false;
+		}
+		for (size_t i = 0; i < names.size(); i++) {
+			out[match->indices[i]] = args.kwd_value(i);
+		}
+		return true;
+	}
+	KwdMatcher::~KwdMatcher() {
+		delete this->cached.load();
 	}
 
 	_PropertyValueAssigner::_PropertyValueAssigner(CallableHelper* target) :
@@ -217,6 +483,9 @@ namespace Silicon {
 	CallableHelper& _PropertyValueAssigner::operator=(const CallableHelper::functype op) const {
 		return (*this->target = CallableHelper(op));
 	}
+	CallableHelper& _PropertyValueAssigner::operator=(const CallableHelper::vectorfunc op) const {
+		return (*this->target = CallableHelper(op));
+	}
 	PropertyHelper::PropertyHelper(CallableHelper getter) :
 		_getter(getter), _setter(nullptr), getter(&_getter), setter(&_setter)
 	{}
@@ -234,46 +503,38 @@ namespace Silicon {
 	BoundPropertyHelper::BoundPropertyHelper(CallableHelper& getter, CallableHelper& setter, Object* owner) :
 		getter(getter), setter(setter), self(owner)
 	{
-		if (this->self) {
-			this->self->incRef();
-		}
+		Object::_incRef(this->self);
 	}
 	BoundPropertyHelper::BoundPropertyHelper(const BoundPropertyHelper& other) :
 		getter(other.getter), setter(other.setter), self(other.self)
 	{
-		if (this->self) {
-			this->self->incRef();
-		}
+		Object::_incRef(this->self);
 	}
 	BoundPropertyHelper& BoundPropertyHelper::operator =(const BoundPropertyHelper& other) {
 		this->getter = other.getter;
 		this->setter = other.setter;
 		auto tmp = this->self;
 		this->self = other.self;
-		if (this->self) {
-			this->self->incRef();
-		}
-		if (tmp) {
-			tmp->decRef();
-		}
+		Object::_incRef(this->self);
+		Object::_decRef(tmp);
 		return *this;
 	}
-	Object* BoundPropertyHelper::get() {
+	Ref<Object> BoundPropertyHelper::get() {
 		if (!this->getter) {
 			return nullptr;
 		}
-		return this->getter({ this->self }).operator->();
+		Object* argv[2] = { nullptr, this->self };
+		return this->getter.vectorcall(ArgVector(argv + 1, 1, {}, true));
 	}
 	bool BoundPropertyHelper::set(Object* value) {
 		if (!this->setter) {
 			return false;
 		}
-		return this->setter({ this->self, value }) != nullptr;
+		Object* argv[3] = { nullptr, this->self, value };
+		return this->setter.vectorcall(ArgVector(argv + 1, 2, {}, true)) != nullptr;
 	}
 	BoundPropertyHelper::~BoundPropertyHelper() {
-		if (this->self) {
-			this->self->decRef();
-		}
+		Object::_decRef(this->self);
 	}
 }
 
@@ -2,43 +2,183 @@
 #include "Forward.hpp"
 #include <functional>
 #include <map>
+#include <memory>
+#include <atomic>
+#include <new>
+#include <type_traits>
 
 #define OUT
 
 
 namespace Silicon {
 
+	/*
+	Type-erased native function taking an ArgVector and returning a
+	CallResult, stored without std::function.
+	Function pointers, function pointers with a context pointer and small
+	trivially copyable callables (such as lambdas without captures) are
+	stored inline, so that copying or calling them never allocates.
+	Other callables are moved to the heap once, upon construction, and
+	shared by reference count between copies.
+	*/
+	class NativeCallable {
+	public:
+		static constexpr size_t inline_size = 2 * sizeof(void*);
+
+	private:
+		struct _Shared {
+			std::atomic<uint32_t> refcnt = 1;
+
+			virtual CallResult call(ArgVector args) const = 0;
+			virtual ~_Shared() = default;
+		};
+		template<class F>
+		struct _SharedCallable : _Shared {
+			F func;
+
+			inline _SharedCallable(F&& func) : func(std::move(func)) {}
+			inline CallResult call(ArgVector args) const override {
+				return this->func(args);
+			}
+		};
+		// function pointer bound to its context.
+		struct _ContextCall {
+			CallResult (*func)(void*, ArgVector);
+			void* context;
+
+			CallResult operator ()(ArgVector args) const;
+		};
+
+		template<class F>
+		static constexpr bool _stored_inline = sizeof(F) <= inline_size && alignof(F) <= alignof(void*)
+			&& std::is_trivially_copyable_v<F> && std::is_trivially_destructible_v<F>;
+
+		CallResult (*entry)(const NativeCallable*, ArgVector);
+		alignas(void*) unsigned char storage[inline_size];
+		_Shared* shared;
+
+		template<class F>
+		static CallResult _call_inline(const NativeCallable* self, ArgVector args) {
+			return (*std::launder(reinterpret_cast<const F*>(self->storage)))(args);
+		}
+		static CallResult _call_shared(const NativeCallable* self, ArgVector args);
+
+	public:
+		NativeCallable();
+		NativeCallable(std::nullptr_t);
+		template<class F>
+			requires (!std::same_as<std::decay_t<F>, NativeCallable>) && std::is_invocable_r_v<CallResult, const F&, ArgVector>
+		inline NativeCallable(F func) :
+			entry(nullptr), storage(), shared(nullptr)
+		{
+			if constexpr (std::is_pointer_v<F>) {
+				if (func == nullptr) {
+					return;
+				}
+			}
+			if constexpr (_stored_inline<F>) {
+				new (this->storage) F(func);
+				this->entry = &_call_inline<F>;
+			}
+			else {
+				this->shared = new _SharedCallable<F>(std::move(func));
+				this->entry = &_call_shared;
+			}
+		}
+		NativeCallable(CallResult (*func)(void* context, ArgVector args), void* context);
+		NativeCallable(const NativeCallable&);
+		NativeCallable(NativeCallable&&) noexcept;
+		NativeCallable& operator =(const NativeCallable&);
+		NativeCallable& operator =(NativeCallable&&) noexcept;
+
+		CallResult operator ()(ArgVector args) const;
+		bool operator ==(std::nullptr_t) const;
+		explicit operator bool() const;
+
+		~NativeCallable();
+	};
+
 
 	class CallableHelper {
 	public:
 		using functype = std::function<Ref<Object> (args_t, kwds_t)>;
+		/*
+		Native calling convention. Arguments, keyword arguments included,
+		are borrowed through an ArgVector, so that neither calling nor
+		binding a callable copies them. Errors are returned in the
+		CallResult instead of being thrown. Functions of type functype are
+		adapted to this convention.
+		*/
+		using vectorfunc = NativeCallable;
+		// asynchronous native calling convention, for coroutines. See Async.hpp.
+		using asyncfunc = std::function<AsyncResult (ArgVector)>;
+
+		// keyword arguments of calls that have none.
+		static const kwds_t no_kwds;
 	private:
 
 		union _Impl {
-			functype cfunc;
+			vectorfunc cfunc;
 			Object* sfunc;
 
-			inline _Impl() : cfunc(nullptr) {}
+			inline _Impl() : sfunc(nullptr) {}
 			inline ~_Impl() {}
 		} impl;
 		bool ftype;
+		bool threadsafe;
+
+		struct _AsyncImpl;
+		std::shared_ptr<const _AsyncImpl> asyncimpl;  // nullptr unless the target is asynchronous.
+
+		void _take(CallableHelper&& other);
+		void _release();
 
 	public:
 		CallableHelper();
 		CallableHelper(functype cfunc);
+		CallableHelper(vectorfunc cfunc);
 		CallableHelper(Object* sfunc);
 		CallableHelper(std::nullptr_t);
 		CallableHelper(const CallableHelper&);
 		CallableHelper(CallableHelper&&) noexcept;
 		CallableHelper& operator =(const CallableHelper&);
 		CallableHelper& operator =(CallableHelper&&) noexcept;
-		Ref<Object> operator ()(args_t args, kwds_t kwds = {}) const;
+		Ref<Object> operator ()(const args_t& args, const kwds_t& kwds = no_kwds) const;
+		Ref<Object> vectorcall(ArgVector args) const;
+		/*
+		Same as vectorcall, but errors raised by native callables are
+		returned rather than thrown. Used by calls that do not return to
+		the caller of the API, so that errors only turn into exceptions
+		once, at the boundary.
+		*/
+		CallResult try_vectorcall(ArgVector args) const;
+		/*
+		Declare whether the target can be called from several threads at
+		once. Only thread-safe callables are called in parallel, such as
+		by batch_call. Copies keep the declaration.
+		*/
+		CallableHelper& set_thread_safe(bool threadsafe = true);
+		bool is_thread_safe() const;
+		/*
+		Callable whose target is a coroutine. Synchronous calls block
+		until the coroutine completes, while async_call() awaits it.
+		*/
+		static CallableHelper from_async(asyncfunc func);
+		bool is_async() const;
+		/*
+		Awaitable call: suspends the awaiting coroutine if the target is
+		asynchronous, and is ready at once otherwise. The arguments must
+		stay alive until the call has been awaited.
+		*/
+		AsyncResult async_call(ArgVector args) const;
 		bool operator ==(std::nullptr_t) const;
 		explicit operator bool() const;
 		BoundCallableHelper bind(Object*) const;
 		
-		static bool typeCheckArgs(args_t to_check, argtypes_t types, OUT Ref<Object>* exception);
-		static bool typeCheckKwds(kwds_t to_check, kwdtypes_t types, OUT Ref<Object>* exception);
+		static bool typeCheckArgs(const args_t& to_check, const argtypes_t& types, OUT Ref<Object>* exception);
+		static bool typeCheckArgs(ArgVector to_check, const argtypes_t& types, OUT Ref<Object>* exception);
+		static bool typeCheckKwds(const kwds_t& to_check, const kwdtypes_t& types, OUT Ref<Object>* exception);
+		static bool typeCheckKwds(ArgVector to_check, const kwdtypes_t& types, OUT Ref<Object>* exception);
 
 		~CallableHelper();
 	};
@@ -52,10 +192,44 @@ namespace Silicon {
 		BoundCallableHelper(CallableHelper&, Object*);
 		BoundCallableHelper(const BoundCallableHelper&);
 		BoundCallableHelper& operator =(const BoundCallableHelper&);
-		Ref<Object> operator()(args_t args, kwds_t kwds = {}) const;
+		Ref<Object> operator()(const args_t& args, const kwds_t& kwds = CallableHelper::no_kwds) const;
+		Ref<Object> vectorcall(ArgVector args) const;
+		CallResult try_vectorcall(ArgVector args) const;
+		AsyncResult async_call(ArgVector args) const;
+		bool is_thread_safe() const;
 		~BoundCallableHelper();
 	};
 
+	/*
+	Matches the keyword arguments of calls against the keyword parameters
+	of one callee. The match computed for the last keyword names seen is
+	cached, so that calls passing the same keywords in the same order skip
+	the name lookups.
+	*/
+	class KwdMatcher {
+		struct _Match;
+
+		args_t params;
+		mutable std::atomic<const _Match*> cached;
+
+		const _Match* _get_match(const KwdNames& names) const;
+
+	public:
+		KwdMatcher(args_t params);
+		KwdMatcher(const KwdMatcher&) = delete;
+		KwdMatcher& operator =(const KwdMatcher&) = delete;
+
+		size_t size() const;
+		/*
+		Store into out[i] the value passed for the i-th parameter, or
+		nullptr if none was passed. out must hold size() entries.
+		Returns false if a keyword does not name any parameter.
+		*/
+		bool match(ArgVector args, OUT Object** out) const;
+
+		~KwdMatcher();
+	};
+
 	class BoundPropertyHelper;
 
 	class _PropertyValueAssigner {
@@ -65,8 +239,11 @@ namespace Silicon {
 		_PropertyValueAssigner(CallableHelper*);
 		CallableHelper& operator =(const CallableHelper&) const;
 		CallableHelper& operator =(const CallableHelper::functype) const;
+		CallableHelper& operator =(const CallableHelper::vectorfunc) const;
 	};
 	class PropertyHelper {
+		friend class FieldSlot;
+
 		CallableHelper _getter;
 		CallableHelper _setter;
 
@@ -90,7 +267,7 @@ namespace Silicon {
 		BoundPropertyHelper(const BoundPropertyHelper&);
 		BoundPropertyHelper& operator =(const BoundPropertyHelper&);
 
-		Object* get();
+		Ref<Object> get();
 		bool set(Object* value);
 
 		~BoundPropertyHelper();
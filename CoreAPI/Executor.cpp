@@ -0,0 +1,212 @@
+#include "Executor.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace Silicon {
+
+	using _Task = std::function<void()>;
+
+	struct _WorkerQueue {
+		std::mutex lock;
+		std::deque<_Task> tasks;
+	};
+
+	struct Executor::_State {
+		Executor* owner;
+		std::vector<std::unique_ptr<_WorkerQueue>> queues;
+		std::vector<std::thread> threads;
+
+		std::atomic<size_t> pending = 0;
+		std::atomic<size_t> next_queue = 0;
+
+		std::mutex sleep_lock;
+		std::condition_variable wake;
+		bool stopping = false;
+
+		// worker of the calling thread: its executor and the index of its deque.
+		static thread_local _State* current;
+		static thread_local size_t current_index;
+
+		void push(_Task task);
+		bool pop_local(size_t index, _Task& task);
+		bool steal(size_t thief, _Task& task);
+		bool run_one(size_t index);
+		void work(size_t index);
+	};
+
+	thread_local Executor::_State* Executor::_State::current = nullptr;
+	thread_local size_t Executor::_State::current_index = 0;
+
+	void Executor::_State::push(_Task task) {
+		size_t index = current == this ? current_index : this->next_queue++ % this->queues.size();
+		this->pending++;  // before the push, so that it never goes below the number of queued tasks.
+		{
+			std::lock_guard<std::mutex> guard(this->queues[index]->lock);
+			this->queues[index]->tasks.push_back(std::move(task));
+		}
+		{
+			// a worker between its check of 'pending' and its wait holds the lock.
+			std::lock_guard<std::mutex> guard(this->sleep_lock);
+		}
+		this->wake.notify_one();
+	}
+	bool Executor::_State::pop_local(size_t index, _Task& task) {
+		_WorkerQueue& queue = *this->queues[index];
+		std::lock_guard<std::mutex> guard(queue.lock);
+		if (queue.tasks.empty()) {
+			return false;
+		}
+		task = std::move(queue.tasks.back());
+		queue.tasks.pop_back();
+		return true;
+	}
+	// take the oldest task of another deque, starting after the thief's own.
+	bool Executor::_State::steal(size_t thief, _Task& task) {
+		size_t count = this->queues.size();
+		for (size_t i = 1; i <= count; i++) {
+			size_t victim = (thief + i) % count;
+			if (victim == thief) {
+				continue;
+			}
+			_WorkerQueue& queue = *this->queues[victim];
+			std::lock_guard<std::mutex> guard(queue.lock);
+			if (!queue.tasks.empty()) {
+				task = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+	/*
+	Run one pending task, if any. index is the deque of the calling
+	worker, or queues.size() for threads that are not workers.
+	*/
+	bool Executor::_State::run_one(size_t index) {
+		_Task task;
+		bool found = (index < this->queues.size() && this->pop_local(index, task)) || this->steal(index, task);
+		if (!found) {
+			return false;
+		}
+		this->pending--;
+		task();
+		return true;
+	}
+	void Executor::_State::work(size_t index) {
+		current = this;
+		current_index = index;
+		while (true) {
+			if (this->run_one(index)) {
+				continue;
+			}
+			std::unique_lock<std::mutex> guard(this->sleep_lock);
+			this->wake.wait(guard, [this] {
+				return this->stopping || this->pending.load() > 0;
+			});
+			if (this->stopping && this->pending.load() == 0) {
+				return;
+			}
+		}
+	}
+
+	Executor::Executor(size_t workers) :
+		state(new _State())
+	{
+		this->state->owner = this;
+		for (size_t i = 0; i < std::max<size_t>(workers, 1); i++) {
+			this->state->queues.push_back(std::make_unique<_WorkerQueue>());
+		}
+		for (size_t i = 0; i < this->state->queues.size(); i++) {
+			this->state->threads.emplace_back([state = this->state, i] {
+				state->work(i);
+			});
+		}
+	}
+	Executor& Executor::shared() {
+		static Executor executor(std::max(std::thread::hardware_concurrency(), 1u));
+		return executor;
+	}
+	Executor* Executor::current() {
+		return _State::current ? _State::current->owner : nullptr;
+	}
+	size_t Executor::workers() const {
+		return this->state->threads.size();
+	}
+
+	/*
+	Task calling func and resolving promise with its result. Errors of the
+	call are thrown by unwrap(), and stored into the promise along with
+	those thrown by native code.
+	*/
+	template<class TFunc>
+	static _Task _call_task(TFunc func, args_t args, std::shared_ptr<std::promise<Ref<Object>>> promise) {
+		return [func = std::move(func), args = std::move(args), promise]() {
+			std::vector<Object*> argv(args.size() + 1);  // with the self slot in front.
+			for (size_t i = 0; i < args.size(); i++) {
+				argv[i + 1] = args[i].get();
+			}
+			try {
+				promise->set_value(func.try_vectorcall(ArgVector(argv.data() + 1, args.size(), {}, true)).unwrap());
+			}
+			catch (...) {
+				promise->set_exception(std::current_exception());
+			}
+		};
+	}
+
+	std::future<Ref<Object>> Executor::submit(const CallableHelper& func, args_t args) {
+		if (!func.is_thread_safe()) {
+			throw SiliconException("only thread-safe callables can be submitted to an executor.");
+		}
+		auto promise = std::make_shared<std::promise<Ref<Object>>>();
+		std::future<Ref<Object>> result = promise->get_future();
+		this->state->push(_call_task(func, std::move(args), promise));
+		return result;
+	}
+	std::future<Ref<Object>> Executor::submit(const BoundCallableHelper& func, args_t args) {
+		if (!func.is_thread_safe()) {
+			throw SiliconException("only thread-safe callables can be submitted to an executor.");
+		}
+		auto promise = std::make_shared<std::promise<Ref<Object>>>();
+		std::future<Ref<Object>> result = promise->get_future();
+		this->state->push(_call_task(func, std::move(args), promise));
+		return result;
+	}
+	void Executor::spawn(std::function<void()> task) {
+		this->state->push(std::move(task));
+	}
+	void Executor::_ScheduleAwaiter::await_suspend(std::coroutine_handle<> awaiting) const {
+		this->executor->spawn([awaiting]() {
+			awaiting.resume();
+		});
+	}
+	Ref<Object> Executor::join(std::future<Ref<Object>>& result) {
+		size_t index = _State::current == this->state ? _State::current_index : this->state->queues.size();
+		while (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			if (!this->state->run_one(index)) {
+				std::this_thread::yield();
+			}
+		}
+		return result.get();
+	}
+
+	Executor::~Executor() {
+		{
+			std::lock_guard<std::mutex> guard(this->state->sleep_lock);
+			this->state->stopping = true;
+		}
+		this->state->wake.notify_all();
+		for (auto& thread : this->state->threads) {
+			thread.join();
+		}
+		delete this->state;
+	}
+}
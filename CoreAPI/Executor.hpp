@@ -0,0 +1,74 @@
+#pragma once
+#include "Ref.hpp"
+#include <coroutine>
+#include <functional>
+#include <future>
+
+
+namespace Silicon {
+
+	/*
+	Task executor with one deque of tasks per worker thread. Workers run
+	the tasks of their own deque last in, first out, and steal the oldest
+	tasks of other workers when theirs is empty.
+	Tasks submitted from a worker are pushed onto that worker's deque, so
+	that nested tasks run close to their parent. Tasks submitted from other
+	threads are spread over the deques.
+	*/
+	class Executor {
+		struct _State;
+
+		_State* state;
+
+	public:
+		Executor(size_t workers);
+		Executor(const Executor&) = delete;
+		Executor& operator =(const Executor&) = delete;
+
+		// executor shared by the runtime, with one worker per hardware thread.
+		static Executor& shared();
+		// executor whose worker is the calling thread, or nullptr.
+		static Executor* current();
+
+		size_t workers() const;
+
+		/*
+		Schedule a call of func, and return a future for its result.
+		Arguments are held until the call returns. Errors of the call are
+		thrown by the future's get().
+		func must be declared thread-safe, and a bound callable must not
+		outlive the callable it binds.
+		*/
+		std::future<Ref<Object>> submit(const CallableHelper& func, args_t args);
+		std::future<Ref<Object>> submit(const BoundCallableHelper& func, args_t args);
+		// schedule a native task.
+		void spawn(std::function<void()> task);
+
+		struct _ScheduleAwaiter {
+			Executor* executor;
+
+			inline bool await_ready() const noexcept {
+				return false;
+			}
+			void await_suspend(std::coroutine_handle<> awaiting) const;
+			inline void await_resume() const noexcept {}
+		};
+		/*
+		Awaitable resuming the awaiting coroutine as a task of this
+		executor. Coroutines that suspend on I/O can be resumed this way
+		without blocking a worker in the meantime.
+		*/
+		inline _ScheduleAwaiter schedule() {
+			return { this };
+		}
+
+		/*
+		Wait for the result of a task. Waiting threads run pending tasks
+		in the meantime, so that a task can wait for the tasks it spawned
+		without holding up a worker.
+		*/
+		Ref<Object> join(std::future<Ref<Object>>& result);
+
+		~Executor();
+	};
+}
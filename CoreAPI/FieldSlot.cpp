@@ -0,0 +1,100 @@
+#include "FieldSlot.hpp"
+
+
+namespace Silicon {
+
+	static Ref<Object> _get_nothing(const FieldSlot&, Object*) {
+		return nullptr;
+	}
+	static bool _set_nothing(const FieldSlot&, Object*, Object*) {
+		return false;
+	}
+
+	FieldSlot::FieldSlot() :
+		type(nullptr), layout(nullptr), field(nullptr), property(nullptr), name(), area_start(0), offset(0),
+		getter(&_get_nothing), setter(&_set_nothing), slot_kind(Kind::NONE)
+	{}
+	FieldSlot::FieldSlot(Type* type, const InternalAPI::MemoryLayout* layout, const FieldInfo* field) :
+		type(type), layout(layout), field(field), property(nullptr), name(),
+		area_start(layout->c_size + layout->c_pad), offset(field->offset)
+	{
+		if (field->unboxed) {
+			this->getter = &FieldSlot::_get_unboxed;
+			this->setter = &FieldSlot::_set_unboxed;
+			this->slot_kind = Kind::UNBOXED;
+		}
+		else {
+			this->getter = &FieldSlot::_get_boxed;
+			this->setter = &FieldSlot::_set_boxed;
+			this->slot_kind = Kind::BOXED;
+		}
+	}
+	FieldSlot::FieldSlot(Type* type, const PropertyHelper* property) :
+		type(type), layout(nullptr), field(nullptr), property(property), name(), area_start(0), offset(0),
+		getter(&FieldSlot::_get_property), setter(&FieldSlot::_set_property), slot_kind(Kind::PROPERTY)
+	{}
+	FieldSlot::FieldSlot(Type* type, const char* name) :
+		type(type), layout(nullptr), field(nullptr), property(nullptr), name(name), area_start(0), offset(0),
+		getter(&FieldSlot::_get_dynamic), setter(&FieldSlot::_set_dynamic), slot_kind(Kind::DYNAMIC)
+	{}
+	const Shape* FieldSlot::shape_of(Object* instance) const {
+		return this->type->_shape_of(instance);
+	}
+	Object** FieldSlot::dynamic_at(Object* instance, size_t index) const {
+		return this->type->_dynamic_at(instance, index);
+	}
+	void FieldSlot::set_dynamic_at(Object* instance, size_t index, Object* value) const {
+		Object*& stored = *this->type->_dynamic_at(instance, index);
+		Object* old = stored;
+		stored = value;
+		Object::_incRef(stored);
+		Object::_decRef(old);
+	}
+
+	Ref<Object> FieldSlot::_get_boxed(const FieldSlot& slot, Object* instance) {
+		return *static_cast<Object**>(slot.address(instance));
+	}
+	bool FieldSlot::_set_boxed(const FieldSlot& slot, Object* instance, Object* value) {
+		Type* field_type = slot.field->type;
+		if (value != nullptr && field_type != nullptr && !field_type->instance_check(value)) {
+			return false;
+		}
+		Object*& stored = *static_cast<Object**>(slot.address(instance));
+		Object* old = stored;
+		stored = value;
+		Object::_incRef(stored);
+		Object::_decRef(old);
+		return true;
+	}
+	Ref<Object> FieldSlot::_get_unboxed(const FieldSlot& slot, Object* instance) {
+		return slot.field->type->inplace_reader(slot.address(instance), slot.field->size);
+	}
+	bool FieldSlot::_set_unboxed(const FieldSlot& slot, Object* instance, Object* value) {
+		Type* field_type = slot.field->type;
+		if (value == nullptr || !field_type->instance_check(value)) {
+			return false;  // unboxed fields always hold a value.
+		}
+		return field_type->inplace_writer(slot.address(instance), slot.field->size, value);
+	}
+	Ref<Object> FieldSlot::_get_property(const FieldSlot& slot, Object* instance) {
+		if (!slot.property->_getter) {
+			return nullptr;
+		}
+		Object* argv[2] = { nullptr, instance };
+		return slot.property->_getter.vectorcall(ArgVector(argv + 1, 1, {}, true));
+	}
+	bool FieldSlot::_set_property(const FieldSlot& slot, Object* instance, Object* value) {
+		if (!slot.property->_setter) {
+			return false;
+		}
+		Object* argv[3] = { nullptr, instance, value };
+		return slot.property->_setter.vectorcall(ArgVector(argv + 1, 2, {}, true)) != nullptr;
+	}
+	Ref<Object> FieldSlot::_get_dynamic(const FieldSlot& slot, Object* instance) {
+		Object** value = slot.type->_dynamic_slot(instance, slot.name.c_str(), false);
+		return value ? *value : nullptr;
+	}
+	bool FieldSlot::_set_dynamic(const FieldSlot& slot, Object* instance, Object* value) {
+		return slot.type->_set_dynamic(instance, slot.name.c_str(), value);
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include "Ref.hpp"
+#include "../InternalAPI/ObjectMemory.hpp"
+#include <string>
+
+
+namespace Silicon {
+
+	/*
+	Direct access to a field or property of the instances of a type,
+	resolved once by name with Type::get_slot(). Accessing a field through
+	a slot involves no lookup: its storage is at a fixed offset from the
+	instance (behind the cold block pointer for cold fields), and values
+	are converted by functions chosen for its representation upon
+	resolution. Dynamic attributes (see TypeDef::dynamic_attributes) have
+	no fixed storage: their slots look them up in the shape of each
+	instance, unless the caller caches their index for that shape.
+	A slot only applies to instances of exactly the type it was resolved
+	on, see applies_to(), and must not outlive that type.
+	*/
+	class FieldSlot {
+	public:
+		enum class Kind : uint8_t {
+			NONE,
+			BOXED,
+			UNBOXED,
+			PROPERTY,
+			DYNAMIC
+		};
+		using getfunc = Ref<Object> (*)(const FieldSlot& slot, Object* instance);
+		using setfunc = bool (*)(const FieldSlot& slot, Object* instance, Object* value);
+
+	private:
+		friend class Type;
+
+		Type* type;
+		const InternalAPI::MemoryLayout* layout;
+		const FieldInfo* field;  // nullptr unless the slot is a field.
+		const PropertyHelper* property;  // nullptr unless the slot is a property.
+		std::string name;  // empty unless the slot is a dynamic attribute.
+		size_t area_start;  // from the most derived C instance to the field area.
+		size_t offset;
+		getfunc getter;
+		setfunc setter;
+		Kind slot_kind;
+
+		FieldSlot(Type* type, const InternalAPI::MemoryLayout* layout, const FieldInfo* field);
+		FieldSlot(Type* type, const PropertyHelper* property);
+		FieldSlot(Type* type, const char* name);
+
+		static Ref<Object> _get_boxed(const FieldSlot&, Object*);
+		static bool _set_boxed(const FieldSlot&, Object*, Object*);
+		static Ref<Object> _get_unboxed(const FieldSlot&, Object*);
+		static bool _set_unboxed(const FieldSlot&, Object*, Object*);
+		static Ref<Object> _get_property(const FieldSlot&, Object*);
+		static bool _set_property(const FieldSlot&, Object*, Object*);
+		static Ref<Object> _get_dynamic(const FieldSlot&, Object*);
+		static bool _set_dynamic(const FieldSlot&, Object*, Object*);
+
+	public:
+		// slot that resolves to nothing.
+		FieldSlot();
+
+		inline Kind kind() const {
+			return this->slot_kind;
+		}
+		inline explicit operator bool() const {
+			return this->slot_kind != Kind::NONE;
+		}
+		inline Type* get_type() const {
+			return this->type;
+		}
+		inline bool applies_to(Object* instance) const {
+			return instance != nullptr && type_of(instance) == this->type;
+		}
+
+		/*
+		Storage of the field in an instance. Requires a field slot that
+		applies to the instance.
+		*/
+		inline void* address(Object* instance) const {
+			byte* area = reinterpret_cast<byte*>(instance) - this->layout->c_root_offset + this->area_start;
+			if (this->field->cold) {
+				area = *reinterpret_cast<byte**>(area + this->layout->cold_slot);
+			}
+			return area + this->offset;
+		}
+		// whether the slot is an unboxed field that can be accessed as a T.
+		template<class T>
+			requires std::is_trivially_copyable_v<T>
+		inline bool holds() const {
+			return this->slot_kind == Kind::UNBOXED && this->field->size == sizeof(T) && this->field->align >= alignof(T);
+		}
+		/*
+		Typed access to an unboxed field, with no conversion. Requires
+		holds<T>(), and a slot that applies to the instance.
+		*/
+		template<class T>
+			requires std::is_trivially_copyable_v<T>
+		inline T& at(Object* instance) const {
+			return *static_cast<T*>(this->address(instance));
+		}
+
+		/*
+		Read or write the field or property as an object. Requires a slot
+		that applies to the instance. Setting a field fails if the value is
+		not an instance of the type of the field.
+		*/
+		inline Ref<Object> get(Object* instance) const {
+			return this->getter(*this, instance);
+		}
+		inline bool set(Object* instance, Ref<Object> value) const {
+			return this->setter(*this, instance, value.get());
+		}
+
+		/*
+		Dynamic attribute slots: the name of the attribute, the shape of an
+		instance, and the storage of the attribute of an instance at an
+		index found in its shape. Require a dynamic slot that applies to
+		the instance.
+		*/
+		inline const char* get_name() const {
+			return this->name.c_str();
+		}
+		const Shape* shape_of(Object* instance) const;
+		Object** dynamic_at(Object* instance, size_t index) const;
+		void set_dynamic_at(Object* instance, size_t index, Object* value) const;
+	};
+}
@@ -16,6 +16,9 @@ namespace Silicon {
 	class TypeDef;
 	class BoundCallableHelper;
 	class Allocator;
+	class ObjectArray;
+	class FieldSlot;
+	class Shape;
 
 
 	namespace _Helpers {
@@ -77,6 +80,9 @@ namespace Silicon {
 	template<object_class T>
 	class Ref;
 
+	class CallResult;
+	class AsyncResult;
+
 
 	template<class T>
 	using namedict = std::unordered_map<std::string, T>;
@@ -90,12 +96,92 @@ namespace Silicon {
 	typedef std::vector<Ref<Type>> argtypes_t;
 	typedef refdict<Object, Ref<Type>> kwdtypes_t;
 
+	/*
+	Borrowed view of the names of the keyword arguments of a call.
+	Names are objects compared by identity. Call sites that always pass
+	the same keywords can keep one array of names and reuse it.
+	*/
+	class KwdNames {
+		Object* const* names;
+		size_t count;
+
+	public:
+		inline KwdNames() :
+			names(nullptr), count(0)
+		{}
+		inline KwdNames(Object* const* names, size_t count) :
+			names(names), count(count)
+		{}
+		inline size_t size() const {
+			return this->count;
+		}
+		inline Object* operator [](size_t index) const {
+			return this->names[index];
+		}
+	};
+
+	/*
+	Borrowed view of the arguments of a call, stored as a contiguous
+	array of object pointers. The caller keeps the arguments alive for
+	the duration of the call.
+	The values of keyword arguments follow the positional arguments in
+	the array, in the order of their names. Calls without keywords have
+	no names at all, so passing no keywords costs nothing.
+	If the view has a self slot, the element right before the first
+	argument is reserved, and can be overwritten by the callee to prepend
+	a 'self' argument without copying the others.
+	*/
+	class ArgVector {
+		Object** first;
+		size_t count;
+		KwdNames kwnames;
+		bool self_slot;
+
+	public:
+		inline ArgVector() :
+			first(nullptr), count(0), kwnames(), self_slot(false)
+		{}
+		inline ArgVector(Object** first, size_t count, KwdNames kwnames = {}, bool self_slot = false) :
+			first(first), count(count), kwnames(kwnames), self_slot(self_slot)
+		{}
+		// number of positional arguments.
+		inline size_t size() const {
+			return this->count;
+		}
+		inline Object* operator [](size_t index) const {
+			return this->first[index];
+		}
+		inline Object** begin() const {
+			return this->first;
+		}
+		inline Object** end() const {
+			return this->first + this->count;
+		}
+		inline const KwdNames& kwd_names() const {
+			return this->kwnames;
+		}
+		inline Object* kwd_value(size_t index) const {
+			return this->first[this->count + index];
+		}
+		inline bool has_self_slot() const {
+			return this->self_slot;
+		}
+		/*
+		Write self into the reserved slot and return the view that
+		starts with it. Requires has_self_slot().
+		*/
+		inline ArgVector with_self(Object* self) const {
+			this->first[-1] = self;
+			return ArgVector(this->first - 1, this->count + 1, this->kwnames);
+		}
+	};
+
 	/*
 	The 'Type' object associated with class T.
+	Refers to T::typeObject, so that it can be constant-initialized.
 	*/
 	template<object_class T>
-	
-	Type* typeof = T::typeObject;
+	Type* const& typeof = T::typeObject;
 
 	/*template<class TSrc, class TDst>
 	TDst& bit_cast(TSrc& src) {
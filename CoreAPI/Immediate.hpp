@@ -0,0 +1,101 @@
+/*
+Immediate values: small integers, booleans and None, encoded in the bits
+of an object pointer instead of being allocated.
+*/
+#pragma once
+#include "Forward.hpp"
+#include <cstdint>
+
+
+namespace Silicon {
+
+	/*
+	Allocated objects are at least pointer-aligned, so the two lowest bits
+	of their address are always clear. A pointer with one of them set is
+	an immediate value rather than the address of an object:
+	 - bit 0 set: a small integer, stored in the other bits;
+	 - bits 0-1 equal to 2: None, False or True.
+	Immediates can be held by Ref<Object> and passed as an Object* to the
+	APIs that accept values, such as argument vectors, fields and
+	attributes, but are never dereferenced: Object member functions
+	require allocated objects. They are never reference counted, and
+	their type is given by their tag (see Silicon::type_of).
+	*/
+	namespace Immediate {
+		constexpr uintptr_t tag_mask = 3;
+		constexpr uintptr_t int_tag = 1;
+		constexpr uintptr_t special_tag = 2;
+
+		constexpr intptr_t int_min = INTPTR_MIN >> 1;
+		constexpr intptr_t int_max = INTPTR_MAX >> 1;
+
+		// types of immediates. Their instances cannot be allocated.
+		extern Type* int_type;
+		extern Type* bool_type;
+		extern Type* none_type;
+
+		inline uintptr_t _bits(const Object* value) {
+			return reinterpret_cast<uintptr_t>(value);
+		}
+		inline Object* _from_bits(uintptr_t bits) {
+			return reinterpret_cast<Object*>(bits);
+		}
+
+		inline Object* none() {
+			return _from_bits(special_tag);
+		}
+		inline Object* false_value() {
+			return _from_bits((1 << 2) | special_tag);
+		}
+		inline Object* true_value() {
+			return _from_bits((2 << 2) | special_tag);
+		}
+
+		inline bool is_immediate(const Object* value) {
+			return (_bits(value) & tag_mask) != 0;
+		}
+		inline bool is_int(const Object* value) {
+			return (_bits(value) & int_tag) != 0;
+		}
+		inline bool is_bool(const Object* value) {
+			return value == false_value() || value == true_value();
+		}
+		inline bool is_none(const Object* value) {
+			return value == none();
+		}
+
+		inline bool fits_int(intmax_t value) {
+			return value >= int_min && value <= int_max;
+		}
+		// requires fits_int(value).
+		inline Object* from_int(intptr_t value) {
+			return _from_bits((static_cast<uintptr_t>(value) << 1) | int_tag);
+		}
+		// requires is_int(value).
+		inline intptr_t to_int(const Object* value) {
+			return static_cast<intptr_t>(_bits(value)) >> 1;
+		}
+		inline Object* from_bool(bool value) {
+			return value ? true_value() : false_value();
+		}
+		/*
+		Addresses are passed as integers, such as the storage returned by
+		"operator new". Requires an address that fits an integer, which
+		pointer-aligned addresses of user space memory do.
+		*/
+		inline Object* from_address(void* address) {
+			return from_int(static_cast<intptr_t>(reinterpret_cast<uintptr_t>(address) >> 1));
+		}
+		inline void* to_address(const Object* value) {
+			return reinterpret_cast<void*>(static_cast<uintptr_t>(to_int(value)) << 1);
+		}
+
+		// truth value of an object: false for nullptr, None, False and 0, true otherwise.
+		inline bool truth(const Object* value) {
+			return value != nullptr && value != none() && value != false_value() && value != from_int(0);
+		}
+
+		// type of an immediate value. Requires is_immediate(value).
+		Type* type_of(const Object* value);
+	}
+}
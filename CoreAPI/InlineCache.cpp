@@ -0,0 +1,115 @@
+#include "InlineCache.hpp"
+#include "Shape.hpp"
+
+
+namespace Silicon {
+
+	MethodCache::MethodCache(const char* name) :
+		name(name), entries(), count(0), next(0)
+	{}
+	const CallableHelper* MethodCache::_miss(Type* type) {
+		uint32_t version = type->get_version();
+		const CallableHelper* method;
+		if (!type->get_method(this->name.c_str(), &method)) {
+			method = nullptr;
+		}
+
+		// refresh the entry of a type whose methods were patched, or take a new one.
+		_Entry* entry = nullptr;
+		for (size_t i = 0; i < this->count; i++) {
+			if (this->entries[i].type.get() == type) {
+				entry = &this->entries[i];
+				break;
+			}
+		}
+		if (entry == nullptr) {
+			if (this->count < max_entries) {
+				entry = &this->entries[this->count++];
+			}
+			else {
+				entry = &this->entries[this->next];
+				this->next = (this->next + 1) % max_entries;
+			}
+			entry->type = type;
+		}
+		entry->version = version;
+		entry->method = method;
+		return method;
+	}
+	CallResult MethodCache::try_call(Object* self, ArgVector args) {
+		if (self == nullptr) {
+			return CallError::wrong_type;
+		}
+		Type* type = type_of(self);
+		_DispatchGuard guard(type);
+		const CallableHelper* method;
+		if (!this->lookup(type, &method)) {
+			return CallError::not_callable;
+		}
+		return method->bind(self).try_vectorcall(args);
+	}
+	void MethodCache::clear() {
+		for (size_t i = 0; i < this->count; i++) {
+			this->entries[i] = _Entry();
+		}
+		this->count = 0;
+		this->next = 0;
+	}
+
+	const FieldSlot AttributeCache::nothing;
+
+	AttributeCache::AttributeCache(const char* name) :
+		name(name), entries(), count(0), next(0), shapes(), shape_count(0), shape_next(0)
+	{}
+	const FieldSlot& AttributeCache::_miss(Type* type) {
+		_Entry* entry;
+		if (this->count < max_entries) {
+			entry = &this->entries[this->count++];
+		}
+		else {
+			entry = &this->entries[this->next];
+			this->next = (this->next + 1) % max_entries;
+		}
+		entry->type = type;
+		entry->slot = type->get_slot(this->name.c_str());
+		return entry->slot;
+	}
+	size_t AttributeCache::_shape_miss(const FieldSlot& slot, const Shape* shape) {
+		size_t index;
+		if (!shape->find(this->name.c_str(), &index)) {
+			index = missing;
+		}
+		_ShapeEntry* entry;
+		if (this->shape_count < max_entries) {
+			entry = &this->shapes[this->shape_count++];
+		}
+		else {
+			entry = &this->shapes[this->shape_next];
+			this->shape_next = (this->shape_next + 1) % max_entries;
+		}
+		entry->type = slot.get_type();
+		entry->shape = shape;
+		entry->index = index;
+		return index;
+	}
+	bool AttributeCache::_set_dynamic(const FieldSlot& slot, Object* instance, Object* value) {
+		size_t index = this->_dynamic_index(slot, instance);
+		if (index == missing) {
+			return slot.set(instance, value);  // adds the attribute, changing the shape of instance.
+		}
+		slot.set_dynamic_at(instance, index, value);
+		return true;
+	}
+	void AttributeCache::clear() {
+		for (size_t i = 0; i < this->count; i++) {
+			this->entries[i] = _Entry();
+		}
+		for (size_t i = 0; i < this->shape_count; i++) {
+			this->shapes[i] = _ShapeEntry();
+		}
+		this->count = 0;
+		this->next = 0;
+		this->shape_count = 0;
+		this->shape_next = 0;
+	}
+}
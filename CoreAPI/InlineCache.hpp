@@ -0,0 +1,177 @@
+/*
+Inline caches: lookups of one name, memoized by the call site that
+performs them.
+*/
+#pragma once
+#include "FieldSlot.hpp"
+#include <string>
+
+
+namespace Silicon {
+
+	/*
+	Cache of the lookups of one method name on the types of the receivers
+	seen by a call site. A call site that keeps seeing the same types finds
+	their methods without any hash lookup: an entry is reused as long as
+	the type of the receiver and the version of its methods match.
+	The cache holds up to max_entries types, the oldest entry being
+	replaced beyond that. Missing methods are cached as well.
+	Caches are owned by one call site and are not thread-safe. As with
+	Type::get_method, a method found on a type that is not sealed must only
+	be used under an InternalAPI::EpochGuard.
+	*/
+	class MethodCache {
+	public:
+		static constexpr size_t max_entries = 4;
+
+	private:
+		struct _Entry {
+			Ref<Type> type;
+			uint32_t version;
+			const CallableHelper* method;  // nullptr if the type has no such method.
+		};
+
+		std::string name;
+		_Entry entries[max_entries];
+		size_t count;
+		size_t next;  // entry replaced upon the next miss, once the cache is full.
+
+		const CallableHelper* _miss(Type* type);
+
+	public:
+		MethodCache(const char* name);
+		MethodCache(const MethodCache&) = delete;
+		MethodCache& operator =(const MethodCache&) = delete;
+
+		// same as type->get_method(name, out).
+		inline bool lookup(Type* type, OUT CallableHelper const** out) {
+			uint32_t version = type->get_version();
+			for (size_t i = 0; i < this->count; i++) {
+				const _Entry& entry = this->entries[i];
+				if (entry.type.get() == type && entry.version == version) {
+					*out = entry.method;
+					return entry.method != nullptr;
+				}
+			}
+			*out = this->_miss(type);
+			return *out != nullptr;
+		}
+		/*
+		Call the method on self, through the vectorcall convention.
+		Reports not_callable if the type of self has no such method.
+		*/
+		CallResult try_call(Object* self, ArgVector args);
+
+		inline const char* get_name() const {
+			return this->name.c_str();
+		}
+		inline size_t size() const {
+			return this->count;
+		}
+		inline bool is_monomorphic() const {
+			return this->count == 1;
+		}
+		void clear();
+	};
+
+	/*
+	Cache of the resolution of one field or property name into slots (see
+	FieldSlot) for the types of the instances seen by a call site. Fields
+	and properties do not change once a type is finalized, so entries are
+	matched on the type of the instance only. Dynamic attributes are
+	found by the index they have in the shape of the instance, which is
+	cached as well for up to max_entries shapes.
+	Same rules as MethodCache otherwise.
+	*/
+	class AttributeCache {
+	public:
+		static constexpr size_t max_entries = MethodCache::max_entries;
+
+	private:
+		static constexpr size_t missing = SIZE_MAX;
+
+		struct _Entry {
+			Ref<Type> type;
+			FieldSlot slot;
+		};
+		struct _ShapeEntry {
+			Ref<Type> type;  // owner of the shape.
+			const Shape* shape;
+			size_t index;  // missing if instances of that shape lack the attribute.
+		};
+
+		std::string name;
+		_Entry entries[max_entries];
+		size_t count;
+		size_t next;
+		_ShapeEntry shapes[max_entries];
+		size_t shape_count;
+		size_t shape_next;
+
+		// slot of nullptr instances.
+		static const FieldSlot nothing;
+
+		const FieldSlot& _miss(Type* type);
+		size_t _shape_miss(const FieldSlot& slot, const Shape* shape);
+		bool _set_dynamic(const FieldSlot& slot, Object* instance, Object* value);
+
+		// index of the dynamic attribute in the shape of instance.
+		inline size_t _dynamic_index(const FieldSlot& slot, Object* instance) {
+			const Shape* shape = slot.shape_of(instance);
+			for (size_t i = 0; i < this->shape_count; i++) {
+				if (this->shapes[i].shape == shape) {
+					return this->shapes[i].index;
+				}
+			}
+			return this->_shape_miss(slot, shape);
+		}
+
+	public:
+		AttributeCache(const char* name);
+		AttributeCache(const AttributeCache&) = delete;
+		AttributeCache& operator =(const AttributeCache&) = delete;
+
+		// slot of the attribute for the type of instance, resolving to nothing for nullptr.
+		inline const FieldSlot& resolve(Object* instance) {
+			if (instance == nullptr) {
+				return nothing;
+			}
+			Type* type = type_of(instance);
+			for (size_t i = 0; i < this->count; i++) {
+				if (this->entries[i].type.get() == type) {
+					return this->entries[i].slot;
+				}
+			}
+			return this->_miss(type);
+		}
+		inline Ref<Object> get(Object* instance) {
+			const FieldSlot& slot = this->resolve(instance);
+			if (slot.kind() == FieldSlot::Kind::DYNAMIC) {
+				size_t index = this->_dynamic_index(slot, instance);
+				if (index == missing) {
+					return nullptr;
+				}
+				return *slot.dynamic_at(instance, index);
+			}
+			return slot.get(instance);
+		}
+		inline bool set(Object* instance, Ref<Object> value) {
+			const FieldSlot& slot = this->resolve(instance);
+			if (slot.kind() == FieldSlot::Kind::DYNAMIC) {
+				return this->_set_dynamic(slot, instance, value.get());
+			}
+			return slot.set(instance, value);
+		}
+
+		inline const char* get_name() const {
+			return this->name.c_str();
+		}
+		inline size_t size() const {
+			return this->count;
+		}
+		inline bool is_monomorphic() const {
+			return this->count == 1;
+		}
+		void clear();
+	};
+}
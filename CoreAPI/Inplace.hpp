@@ -0,0 +1,84 @@
+/*
+In-place storage codecs: conversions between objects and the raw bytes
+they are stored as when unboxed.
+*/
+#pragma once
+#include "Forward.hpp"
+#include "../byteworkaround.hpp"
+#include <concepts>
+#include <type_traits>
+
+
+namespace Silicon {
+
+	/*
+	Functions converting one value. Writers return false if the value
+	cannot be represented in available_space bytes; readers return
+	nullptr if no value can be read from them.
+	*/
+	using inplace_write_fn = bool (*)(void* where, size_t available_space, Object* value);
+	using inplace_read_fn = Object* (*)(void* where, size_t available_space);
+	/*
+	Functions converting count values stored stride bytes apart, each slot
+	being at least the in-place size of the type. Batch writers stop at the
+	first value that cannot be represented, and return the number of values
+	that were written.
+	*/
+	using inplace_write_batch_fn = size_t (*)(void* where, size_t stride, Object* const* values, size_t count);
+	using inplace_read_batch_fn = void (*)(const void* where, size_t stride, Object** values, size_t count);
+
+	/*
+	A codec describes the in-place representation of a type at compile
+	time: the trivially copyable storage_type values are stored as, and
+	static conversions from and to objects. encode() must reject values
+	it cannot represent, as it is the only check done on batch writes.
+	*/
+	template<class TCodec>
+	concept inplace_codec = std::is_trivially_copyable_v<typename TCodec::storage_type> &&
+		requires (Object* value, typename TCodec::storage_type& storage, const typename TCodec::storage_type& stored) {
+			{ TCodec::encode(value, storage) } -> std::same_as<bool>;
+			{ TCodec::decode(stored) } -> std::same_as<Object*>;
+		};
+
+	/*
+	Size and alignment of the in-place representation of a codec, and the
+	storage functions generated from it. Conversions are inlined into the
+	batch functions, so that converting an array of values costs a single
+	indirect call.
+	*/
+	template<inplace_codec TCodec>
+	struct inplace_traits {
+		using storage_type = typename TCodec::storage_type;
+
+		static constexpr size_t size = sizeof(storage_type);
+		static constexpr size_t align = alignof(storage_type);
+
+		static bool write(void* where, size_t available_space, Object* value) {
+			if (available_space < size) {
+				return false;
+			}
+			return TCodec::encode(value, *reinterpret_cast<storage_type*>(where));
+		}
+		static Object* read(void* where, size_t available_space) {
+			if (available_space < size) {
+				return nullptr;
+			}
+			return TCodec::decode(*reinterpret_cast<const storage_type*>(where));
+		}
+		static size_t write_batch(void* where, size_t stride, Object* const* values, size_t count) {
+			byte* slot = reinterpret_cast<byte*>(where);
+			for (size_t i = 0; i < count; i++, slot += stride) {
+				if (!TCodec::encode(values[i], *reinterpret_cast<storage_type*>(slot))) {
+					return i;
+				}
+			}
+			return count;
+		}
+		static void read_batch(const void* where, size_t stride, Object** values, size_t count) {
+			const byte* slot = reinterpret_cast<const byte*>(where);
+			for (size_t i = 0; i < count; i++, slot += stride) {
+				values[i] = TCodec::decode(*reinterpret_cast<const storage_type*>(slot));
+			}
+		}
+	};
+}
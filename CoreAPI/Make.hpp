@@ -0,0 +1,28 @@
+#pragma once
+#include "Ref.hpp"
+#include <utility>
+
+
+namespace Silicon {
+
+	/*
+	Create an instance of a type bound to the C++ class T (see
+	TypeDef::bindCppType), constructed in place from args. Unless the type
+	overrides "operator new", memory is allocated right away from the
+	layout and allocator of the type: no method is looked up and no
+	argument list is built. The constructors of T are expected to pass
+	typeof<T> to the constructor of Object.
+	*/
+	template<complete_obj_class T, class ...TArgs>
+		requires std::constructible_from<T, TArgs...>
+	inline Ref<T> make(TArgs&&... args) {
+		Type* type = typeof<T>;
+		InternalAPI::MemoryLayout* layout;
+		Allocator* allocator;
+		if (type->_direct_new(sizeof(T), &layout, &allocator)) {
+			return Ref<T>(new (nullptr, layout, allocator) T(std::forward<TArgs>(args)...));
+		}
+		// "operator new" is overridden, so it must be dispatched. Throws if it fails.
+		return Ref<T>(new (type) T(std::forward<TArgs>(args)...));
+	}
+}
@@ -0,0 +1,196 @@
+#include "Memoized.hpp"
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+
+namespace Silicon {
+
+	struct Memoized::_Cache {
+		struct _Entry {
+			size_t hash = 0;
+			size_t positional = 0;
+			std::vector<Ref<Object>> key;  // positional arguments, then keyword names and values.
+			Ref<Object> value;
+			bool used = false;
+			bool referenced = false;
+		};
+
+		CallableHelper target;
+		std::vector<_Entry> entries;
+		std::unordered_multimap<size_t, size_t> index;  // hash of the arguments -> entry.
+		size_t hand = 0;
+		size_t count = 0;
+		mutable std::mutex lock;
+
+		std::atomic<size_t> hits = 0;
+		std::atomic<size_t> misses = 0;
+
+		inline _Cache(CallableHelper target, size_t capacity) :
+			target(target), entries(capacity)
+		{}
+
+		static size_t _hash(ArgVector args);
+		static bool _matches(const _Entry& entry, ArgVector args);
+
+		size_t _find(size_t hash, ArgVector args) const;
+		size_t _evict(OUT _Entry* evicted);
+		void _store(size_t hash, ArgVector args, const Ref<Object>& value);
+
+		CallResult call(ArgVector args);
+	};
+
+	size_t Memoized::_Cache::_hash(ArgVector args) {
+		std::hash<Object*> hasher;
+		size_t hash = args.size();
+		auto combine = [&](Object* obj) {
+			hash ^= hasher(obj) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+		};
+		for (Object* arg : args) {
+			combine(arg);
+		}
+		const KwdNames& names = args.kwd_names();
+		for (size_t i = 0; i < names.size(); i++) {
+			combine(names[i]);
+			combine(args.kwd_value(i));
+		}
+		return hash;
+	}
+	bool Memoized::_Cache::_matches(const _Entry& entry, ArgVector args) {
+		const KwdNames& names = args.kwd_names();
+		if (entry.positional != args.size() || entry.key.size() != args.size() + 2 * names.size()) {
+			return false;
+		}
+		for (size_t i = 0; i < args.size(); i++) {
+			if (entry.key[i].get() != args[i]) {
+				return false;
+			}
+		}
+		for (size_t i = 0; i < names.size(); i++) {
+			size_t at = args.size() + 2 * i;
+			if (entry.key[at].get() != names[i] || entry.key[at + 1].get() != args.kwd_value(i)) {
+				return false;
+			}
+		}
+		return true;
+	}
+	// index of the entry cached for args, or entries.size() if there is none. Requires the lock.
+	size_t Memoized::_Cache::_find(size_t hash, ArgVector args) const {
+		auto [begin, end] = this->index.equal_range(hash);
+		for (auto it = begin; it != end; ++it) {
+			if (_matches(this->entries[it->second], args)) {
+				return it->second;
+			}
+		}
+		return this->entries.size();
+	}
+	/*
+	Free an entry with the CLOCK algorithm and return its index: the hand
+	skips entries referenced since it last passed them, clearing their
+	bit. The content of the entry is moved to evicted, so that its
+	references are released after the lock. Requires the lock.
+	*/
+	size_t Memoized::_Cache::_evict(_Entry* evicted) {
+		while (true) {
+			size_t slot = this->hand;
+			_Entry& entry = this->entries[slot];
+			this->hand = (this->hand + 1) % this->entries.size();
+
+			if (!entry.used) {
+				return slot;
+			}
+			if (entry.referenced) {
+				entry.referenced = false;
+				continue;
+			}
+			auto [begin, end] = this->index.equal_range(entry.hash);
+			for (auto it = begin; it != end; ++it) {
+				if (it->second == slot) {
+					this->index.erase(it);
+					break;
+				}
+			}
+			*evicted = std::move(entry);
+			entry = _Entry();
+			this->count--;
+			return slot;
+		}
+	}
+	void Memoized::_Cache::_store(size_t hash, ArgVector args, const Ref<Object>& value) {
+		_Entry evicted;
+		std::lock_guard<std::mutex> guard(this->lock);
+		if (this->_find(hash, args) != this->entries.size()) {
+			return;  // stored by another thread in the meantime.
+		}
+		size_t slot = this->_evict(&evicted);
+		_Entry& entry = this->entries[slot];
+		entry.hash = hash;
+		entry.positional = args.size();
+		entry.key.reserve(args.size() + 2 * args.kwd_names().size());
+		for (Object* arg : args) {
+			entry.key.push_back(arg);
+		}
+		for (size_t i = 0; i < args.kwd_names().size(); i++) {
+			entry.key.push_back(args.kwd_names()[i]);
+			entry.key.push_back(args.kwd_value(i));
+		}
+		entry.value = value;
+		entry.used = true;
+		this->index.emplace(hash, slot);
+		this->count++;
+	}
+	CallResult Memoized::_Cache::call(ArgVector args) {
+		size_t hash = _hash(args);
+		{
+			std::lock_guard<std::mutex> guard(this->lock);
+			size_t slot = this->_find(hash, args);
+			if (slot != this->entries.size()) {
+				this->entries[slot].referenced = true;
+				this->hits.fetch_add(1, std::memory_order_relaxed);
+				return this->entries[slot].value;
+			}
+		}
+		this->misses.fetch_add(1, std::memory_order_relaxed);
+
+		// the target is called without the lock, so that it can be reentered.
+		CallResult result = this->target.try_vectorcall(args);
+		if (result.ok()) {
+			this->_store(hash, args, result.get());
+		}
+		return result;
+	}
+
+	Memoized::Memoized(CallableHelper target, size_t capacity) {
+		if (capacity == 0) {
+			throw SiliconException("the capacity of a memoized callable must not be zero.");
+		}
+		this->cache = std::make_shared<_Cache>(target, capacity);
+	}
+	CallableHelper::vectorfunc Memoized::callable() const {
+		return [cache = this->cache](ArgVector args) -> CallResult {
+			return cache->call(args);
+		};
+	}
+	size_t Memoized::capacity() const {
+		return this->cache->entries.size();
+	}
+	size_t Memoized::size() const {
+		std::lock_guard<std::mutex> guard(this->cache->lock);
+		return this->cache->count;
+	}
+	size_t Memoized::hits() const {
+		return this->cache->hits.load(std::memory_order_relaxed);
+	}
+	size_t Memoized::misses() const {
+		return this->cache->misses.load(std::memory_order_relaxed);
+	}
+	void Memoized::clear() {
+		std::vector<_Cache::_Entry> dropped(this->cache->entries.size());
+		std::lock_guard<std::mutex> guard(this->cache->lock);
+		this->cache->entries.swap(dropped);
+		this->cache->index.clear();
+		this->cache->hand = 0;
+		this->cache->count = 0;
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "Ref.hpp"
+#include <memory>
+
+
+namespace Silicon {
+
+	/*
+	Memoization of a pure callable: results are cached in a bounded table,
+	keyed by the identity of the arguments (keyword names and values
+	included), and returned without calling the target when the same
+	arguments are passed again. Errors are not cached.
+	When the table is full, entries are evicted with the CLOCK algorithm.
+	Cached arguments and results are kept alive by the cache.
+
+	The target must be pure: its result must only depend on the identity
+	of its arguments, and calling it must have no other effect.
+	*/
+	class Memoized {
+		struct _Cache;
+
+		std::shared_ptr<_Cache> cache;
+
+	public:
+		static constexpr size_t default_capacity = 64;
+
+		Memoized(CallableHelper target, size_t capacity = default_capacity);
+
+		/*
+		The memoized callable, following the vectorfunc calling
+		convention. All the copies share the cache of this object, so it
+		can be used as the implementation of a type method.
+		*/
+		CallableHelper::vectorfunc callable() const;
+
+		size_t capacity() const;
+		size_t size() const;
+		size_t hits() const;
+		size_t misses() const;
+		// drop all the cached results. Counters are left unchanged.
+		void clear();
+	};
+}
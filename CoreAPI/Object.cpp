@@ -1,7 +1,19 @@
 #include "Ref.hpp"
 #include "../InternalAPI/ObjectMemory.hpp"
+#include "../InternalAPI/Epoch.hpp"
 #include "Object.hpp"
+#include "typehelper.hpp"
+#include "FieldSlot.hpp"
+#include "Shape.hpp"
+#include "Signature.hpp"
+#include <bit>
 #include <iostream>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <algorithm>
+#include <vector>
 
 
 namespace Silicon {
@@ -16,27 +28,36 @@ namespace Silicon {
 		throw fatal_error(msg);
 	}
 
-	constexpr size_t totalsizeof_type = InternalAPI::MemoryLayout::totalsizeof<Type>(0);
-
-	byte object_type_memory[totalsizeof_type];
-	byte type_type_memory[totalsizeof_type];
-	void* first_allocs_dst;
-
-	struct RootTypes {
-		Type* object_type;
-		Type* type_type;
+	/*
+	Static storage for an object that lives in the image of the type system
+	rather than on the heap. The object header is reserved in front of the
+	object, where ObjectMemory expects it.
+	Storage is constant-initialized, so the address of the object is known
+	before any dynamic initialization takes place; the object itself is
+	constructed in place by TypeSystemRoot::init().
+	*/
+	template<class T>
+	struct _StaticObjectImage {
+		static_assert(InternalAPI::MemoryLayout::head_size % alignof(T) == 0, "the object must directly follow its header.");
+
+		alignas(alignof(void*)) byte head[InternalAPI::MemoryLayout::head_size];
+		union {
+			T object;
+		};
 
-		inline static bool initialized = false;
+		constexpr _StaticObjectImage() : head{} {}
+		~_StaticObjectImage() {}
 	};
 
+	constinit _StaticObjectImage<Type> object_type_image;
+	constinit _StaticObjectImage<Type> type_type_image;
+	constinit _StaticObjectImage<Type> int_type_image;
+	constinit _StaticObjectImage<Type> bool_type_image;
+	constinit _StaticObjectImage<Type> none_type_image;
+
 	struct TypeSystemRoot {
 		static_assert(std::is_base_of_v<Object, Type>, "Object should be a subclass of type.");
-		void* _object_type_address = &(object_type_memory[0]);
-		void* _type_type_address = &(type_type_memory[0]);
-		Type* _object_type = nullptr;
-		Type* _type_type = nullptr;
 
-		inline static TypeSystemRoot* _current = nullptr;
 		inline static Type* object_type = nullptr;
 		inline static Type* type_type = nullptr;
 
@@ -100,6 +121,12 @@ namespace Silicon {
 			throw_fatal_error("failed to insert a method into a type def.");
 		return where->second;
 	}
+	CallableHelper& _TypeMethodDefHelper::operator=(CallableHelper::vectorfunc method) const {
+		auto [where, success] = this->target.insert_or_assign(this->method_name, CallableHelper(method));
+		if (!success)
+			throw_fatal_error("failed to insert a method into a type def.");
+		return where->second;
+	}
 	void TypeDef::_bindCppType(size_t c_size, size_t c_align) {
 		this->c_size = c_size;
 		this->c_align = c_align;
@@ -115,7 +142,16 @@ namespace Silicon {
 		subclassof_impl(this->class_methods, "operator subclassof"),
 		instanceof_impl(this->class_methods, "operator instanceof"),
 		inplace_write(nullptr),
-		inplace_read(nullptr)
+		inplace_read(nullptr),
+		inplace_write_batch(nullptr),
+		inplace_read_batch(nullptr),
+		inplace_size(0),
+		inplace_align(0),
+		sealed(false),
+		instance_align(0),
+		dynamic_attributes(false),
+		inline_attributes(4),
+		allocator(nullptr)
 	{
 		for (Type* tp : bases) {
 			if (tp != nullptr) {
@@ -137,7 +173,14 @@ namespace Silicon {
 		this->instance_methods[name] = CallableHelper(func);
 		return true;
 	}
-	bool TypeDef::addField(const char* name, Type* type) {
+	bool TypeDef::addInstanceMethod(const char* name, CallableHelper::vectorfunc func) {
+		if (this->instance_methods.contains(name)) {
+			return false;
+		}
+		this->instance_methods[name] = CallableHelper(func);
+		return true;
+	}
+	bool TypeDef::addField(const char* name, Type* type, FieldHint hint) {
 		if (this->fields.contains(name)) {
 			return false;
 		}
@@ -145,15 +188,41 @@ namespace Silicon {
 			type->incRef();
 		}
 		this->fields[name] = type;
+		this->field_hints[name] = hint;
+		return true;
+	}
+	bool TypeDef::setFieldHint(const char* name, FieldHint hint) {
+		if (!this->fields.contains(name)) {
+			return false;
+		}
+		this->field_hints[name] = hint;
 		return true;
 	}
+	void TypeDef::applyFieldProfile(const namedict<uint64_t>& access_counts) {
+		uint64_t most = 0;
+		for (auto& [name, count] : access_counts) {
+			if (this->fields.contains(name)) {
+				most = std::max(most, count);
+			}
+		}
+		for (auto& [name, type] : this->fields) {
+			auto found = access_counts.find(name);
+			uint64_t count = found != access_counts.end() ? found->second : 0;
+			if (most != 0 && count * 2 >= most) {
+				this->field_hints[name] = FieldHint::HOT;
+			}
+			else if (count * 64 < most) {
+				this->field_hints[name] = FieldHint::COLD;
+			}
+			else {
+				this->field_hints[name] = FieldHint::NORMAL;
+			}
+		}
+	}
 	PropertyHelper& TypeDef::addProperty(const char* name, CallableHelper getter) {
 		this->properties[name] = PropertyHelper(getter);
 		return this->properties[name];
 	}
-	InternalAPI::MemoryLayout TypeDef::_computeLayout(uint16_t field_count) {
-		return { this->c_size, field_count, this->c_align };
-	}
 	TypeDef::~TypeDef() {
 		for (Type* tp : this->bases) {
 			if (tp != nullptr) {
@@ -169,17 +238,29 @@ namespace Silicon {
 	void* Object::operator new(size_t sz) {
 		return operator new(sz, typeObject);
 	}
+	/*
+	"operator new" returns the address of the storage of the most derived
+	C instance, passed as an integer (see Immediate::from_address).
+	*/
 	void* Object::operator new(size_t sz, Type* rtti) {
-		BoundCallableHelper new_helper;
-		if (!rtti->get_method("operator new", rtti, &new_helper)) {
-			return nullptr;  // error, but should never happen.
+		_DispatchGuard guard(rtti);
+		const CallableHelper* new_impl;
+		if (!rtti->_find_method("operator new", &Type::sealed_new_impl, &new_impl)) {
+			throw SiliconException("the type has no \"operator new\".");
+		}
+		Ref<Object> memory = new_impl->bind(rtti).vectorcall(ArgVector());
+		if (!Immediate::is_int(memory.get())) {
+			throw SiliconException("\"operator new\" did not return an address.");
 		}
-		Ref<Object> obj = new_helper({}, {});
-		return nullptr; // missing a type to encapsulate such return values
+		void* address = Immediate::to_address(memory.get());
+		if (address == nullptr) {
+			throw std::bad_alloc();
+		}
+		return address;
 	}
 	void* Object::operator new(size_t sz, void* where, InternalAPI::MemoryLayout* layout, Allocator* allocator) {
 		if (!TypeSystemRoot::initialized()) {
-			auto layout = new InternalAPI::MemoryLayout(sizeof(Type), 0, alignof(Type), sizeof(Type) - sizeof(Object));
+			auto layout = new InternalAPI::MemoryLayout(sizeof(Type), alignof(Type), 0, alignof(void*), sizeof(Type) - sizeof(Object));
 			return InternalAPI::ObjectMemory::allocate(layout, where, nullptr).most_derived();
 		}
 		return InternalAPI::ObjectMemory::allocate(layout, where, allocator).most_derived();
@@ -219,12 +300,17 @@ namespace Silicon {
 	void Object::__call_ctor__(Type* rtti) {
 		this->Object::Object(rtti);
 	}
+	/*
+	The count is updated atomically, so that objects can be shared between
+	threads. It is accessed through atomic_ref rather than stored as an
+	atomic, so that references taken on the root types before they are
+	constructed are kept.
+	*/
 	void Object::incRef() {
-		this->refcount++;
+		std::atomic_ref<uint32_t>(this->refcount).fetch_add(1, std::memory_order_relaxed);
 	}
 	void Object::decRef() {
-		this->refcount--;
-		if (this->refcount <= 0) {
+		if (std::atomic_ref<uint32_t>(this->refcount).fetch_sub(1, std::memory_order_acq_rel) == 1) {
 			delete this;
 		}
 	}
@@ -232,10 +318,11 @@ namespace Silicon {
 		return this->rtti;
 	}
 	bool Object::inplace_store(void* where, size_t available_space) {
-		if (!this->rtti->supports_inplace_storage()) {
+		Type* type = this->getType();
+		if (!type->supports_inplace_storage()) {
 			return false;
 		}
-		return this->rtti->inplace_writer(where, available_space, this);
+		return type->inplace_writer(where, available_space, this);
 	}
 	Object* Object::inplace_load(Type* rtti, void* where, size_t available_space) {
 		if (!rtti->supports_inplace_storage()) {
@@ -243,8 +330,45 @@ namespace Silicon {
 		}
 		return rtti->inplace_reader(where, available_space);
 	}
+	void* Object::_field_address(const char* name, size_t size, size_t align) {
+		const FieldInfo* field = this->rtti->get_field_info(name);
+		if (field == nullptr || !field->unboxed || field->size != size || field->align < align) {
+			return nullptr;
+		}
+		return this->rtti->_field_storage(this, *field);
+	}
+	Ref<Object> Object::get_field(const char* name) {
+		const FieldInfo* field = this->rtti->get_field_info(name);
+		if (field == nullptr) {
+			return nullptr;
+		}
+		return this->rtti->_load_field(this, *field);
+	}
+	bool Object::set_field(const char* name, Ref<Object> value) {
+		const FieldInfo* field = this->rtti->get_field_info(name);
+		if (field == nullptr) {
+			return false;
+		}
+		return this->rtti->_store_field(this, *field, value);
+	}
+	Ref<Object> Object::get_attribute(const char* name) {
+		const FieldInfo* field = this->rtti->get_field_info(name);
+		if (field != nullptr) {
+			return this->rtti->_load_field(this, *field);
+		}
+		Object** slot = this->rtti->_dynamic_slot(this, name, false);
+		return slot ? *slot : nullptr;
+	}
+	bool Object::set_attribute(const char* name, Ref<Object> value) {
+		const FieldInfo* field = this->rtti->get_field_info(name);
+		if (field != nullptr) {
+			return this->rtti->_store_field(this, *field, value);
+		}
+		return this->rtti->_set_dynamic(this, name, value.get());
+	}
 	Object::~Object() {
 		if (this->rtti) {
+			this->rtti->_release_fields(this);
 			this->rtti->decRef();
 			this->rtti = nullptr;
 		}
@@ -252,6 +376,9 @@ namespace Silicon {
 	void Object::operator delete(void* ptr) {
 		InternalAPI::ObjectMemory::from_most_derived(ptr).free();
 	}
+	void Object::operator delete(void* ptr, Type* rtti) {
+		Object::operator delete(ptr);
+	}
 	void Object::operator delete(void* ptr, void* where, InternalAPI::MemoryLayout* layout, Allocator* allocator) {
 		Object::operator delete(ptr);
 	}
@@ -267,79 +394,369 @@ namespace Silicon {
 	void* Type::operator new(size_t sz, Type* metatype) {
 		return Object::operator new(sz, metatype);
 	}
+	/*
+	Copy of the contents of a TypeDef, kept by a type until it is finalized.
+	Field types are referenced by this copy, and those references are handed
+	over to the type upon finalization.
+	*/
+	struct Type::_PendingDef {
+		namedict<CallableHelper> instance_methods;
+		namedict<CallableHelper> class_methods;
+		namedict<CallableHelper> static_methods;
+		namedict<Type*> fields;
+		namedict<FieldHint> field_hints;
+		namedict<PropertyHelper> properties;
+		size_t c_size;
+		size_t c_align;
+		size_t instance_align;
+		bool dynamic_attributes;
+		size_t inline_attributes;
+	};
+
+	/*
+	Header of the dynamic attributes of an instance, followed by the
+	values of the first dynamic_inline attributes. Instances start with
+	zeroed storage, so a null shape stands for the root shape.
+	*/
+	struct Type::_DynamicAttributes {
+		const Shape* shape;
+		Object** overflow;
+
+		inline Object** inline_values() {
+			return reinterpret_cast<Object**>(this + 1);
+		}
+	};
+
 	Type::Type(TypeDef& definition, Type* metatype) : Object(metatype)
 	{
 		this->bases = definition.bases;
 		this->name = definition.name;
+		this->layout = nullptr;
+		this->root_shape = nullptr;
+		this->dynamic_offset = 0;
+		this->dynamic_inline = 0;
+		this->methods = nullptr;
+		this->version = 0;
+		this->sealed = definition.sealed;
+		this->sealed_new_impl = nullptr;
+		this->sealed_call_impl = nullptr;
+		this->sealed_subclassof_impl = nullptr;
+		this->sealed_instanceof_impl = nullptr;
 
-		this->instance_methods = {};
-		this->class_methods = {};
-		this->static_methods = {};
-		this->static_fields = {};
-		this->properties = {};
-		bool bases_support_inplace_storage = true;
-		this->inplace_writer = nullptr;
-		this->inplace_reader = nullptr;
-
-		uint16_t fieldcount = 0;
 		for (Type* base : this->bases) {
+			if (base->sealed) {
+				throw SiliconException("cannot subclass a sealed type.");
+			}
+		}
+		if ((definition.instance_align & (definition.instance_align - 1)) != 0) {
+			throw SiliconException("the alignment of instances must be a power of two.");
+		}
 
-			// update the layout counter
-			fieldcount += base->layout->fieldcount;
+		// a type without bases has no default type checks to inherit.
+		bool native_subclass_check = !this->bases.empty();
+		bool native_instance_check = !this->bases.empty();
 
+		for (Type* base : this->bases) {
 			// add reference to that base
 			base->incRef();
 
-			// inherit from that base's methods
-			this->instance_methods |= base->instance_methods;
-			this->class_methods |= base->class_methods;
-			this->static_methods |= base->static_methods;
+			// natively answered type checks are only inherited if all bases have them
+			native_subclass_check &= base->native_subclass_check.load();
+			native_instance_check &= base->native_instance_check.load();
+		}
 
-			// same for static fields and properties
-			this->static_fields |= base->static_fields;
-			this->properties |= base->properties;
+		// user defined type checks must always be dispatched.
+		if (definition.class_methods.contains("operator subclassof")) {
+			native_subclass_check = false;
+		}
+		if (definition.class_methods.contains("operator instanceof")) {
+			native_instance_check = false;
+		}
+		this->native_subclass_check = native_subclass_check;
+		this->native_instance_check = native_instance_check;
+
+		// same for allocation, which is done natively unless "operator new" is overridden.
+		bool native_new = !this->bases.empty();
+		for (Type* base : this->bases) {
+			native_new &= base->native_new.load();
+		}
+		if (definition.class_methods.contains("operator new")) {
+			native_new = false;
+		}
+		this->native_new = native_new;
+		this->allocator = definition.allocator;
 
-			// a class can only support inplace storage if all of its bases do so as well
+		/*
+		In-place storage is set up right away rather than upon finalization,
+		so that the layouts of other types can tell whether fields of this
+		type are unboxed without finalizing it.
+		A class can only support inplace storage if all of its bases do so as well.
+		*/
+		bool bases_support_inplace_storage = true;
+		for (Type* base : this->bases) {
 			bases_support_inplace_storage &= base->supports_inplace_storage();
 		}
-		if (bases_support_inplace_storage) {
+		this->inplace_writer = nullptr;
+		this->inplace_reader = nullptr;
+		this->inplace_batch_writer = nullptr;
+		this->inplace_batch_reader = nullptr;
+		this->inplace_size = 0;
+		this->inplace_align = 0;
+		if (bases_support_inplace_storage && definition.inplace_write && definition.inplace_read) {
 			this->inplace_writer = definition.inplace_write;
 			this->inplace_reader = definition.inplace_read;
+			this->inplace_batch_writer = definition.inplace_write_batch;
+			this->inplace_batch_reader = definition.inplace_read_batch;
+			this->inplace_size = definition.inplace_size;
+			this->inplace_align = definition.inplace_align ? definition.inplace_align : alignof(void*);
+		}
+
+		/*
+		Only record the definition for now. Merging the method tables of the
+		bases and computing the memory layout is deferred to the first use of
+		the type, see Type::finalize().
+		*/
+		this->pending = std::unique_ptr<_PendingDef>(new _PendingDef{
+			definition.instance_methods,
+			definition.class_methods,
+			definition.static_methods,
+			definition.fields,
+			definition.field_hints,
+			definition.properties,
+			definition.c_size,
+			definition.c_align,
+			definition.instance_align,
+			definition.dynamic_attributes,
+			definition.inline_attributes
+		});
+		for (auto& [name, type] : this->pending->fields) {
+			if (type != nullptr) {
+				type->incRef();
+			}
+		}
+	}
+	/*
+	Place fields one after the other from offset 'size' of an area, in
+	decreasing order of alignment, so that no padding is needed between
+	them. Updates the size and alignment of the area.
+	*/
+	static void _pack_fields(std::vector<std::pair<std::string, FieldInfo>>& fields, size_t& size, size_t& align) {
+		std::sort(fields.begin(), fields.end(), [](auto& lhs, auto& rhs) {
+			if (lhs.second.align != rhs.second.align) {
+				return lhs.second.align > rhs.second.align;
+			}
+			if (lhs.second.size != rhs.second.size) {
+				return lhs.second.size > rhs.second.size;
+			}
+			return lhs.first < rhs.first;  // keeps layouts deterministic.
+		});
+		for (auto& [name, field] : fields) {
+			field.offset = inthandling::align_up(size, field.align);
+			size = field.offset + field.size;
+			align = std::max(align, field.align);
 		}
-		else {
-			this->inplace_writer = nullptr;
-			this->inplace_reader = nullptr;
+	}
+
+	void Type::_finalize() {
+		_PendingDef& definition = *this->pending;
+
+		_MethodTables* methods = new _MethodTables();
+		this->static_fields = {};
+		this->properties = {};
+
+		for (Type* base : this->bases) {
+			base->finalize();
+
+			/*
+			inherit from that base's methods, along with the native flags
+			matching them: the base may have been patched since this type
+			was created.
+			*/
+			std::lock_guard<std::mutex> lock(base->patch_lock);
+			const _MethodTables* base_methods = base->methods.load();
+			if (!base->native_subclass_check) {
+				this->native_subclass_check = false;
+			}
+			if (!base->native_instance_check) {
+				this->native_instance_check = false;
+			}
+			if (!base->native_new) {
+				this->native_new = false;
+			}
+			methods->instance_methods |= base_methods->instance_methods;
+			methods->class_methods |= base_methods->class_methods;
+			methods->static_methods |= base_methods->static_methods;
+
+			// same for static fields and properties
+			this->static_fields |= base->static_fields;
+			this->properties |= base->properties;
 		}
 
 		// now add methods defined by the user, so they can override that from base classes.
-		this->instance_methods |= definition.instance_methods;
-		this->class_methods |= definition.class_methods;
-		this->static_methods |= definition.static_methods;
+		methods->instance_methods |= definition.instance_methods;
+		methods->class_methods |= definition.class_methods;
+		methods->static_methods |= definition.static_methods;
 		this->properties |= definition.properties;
+		this->methods = methods;
 
-		// define the field layout for instances
+		if (this->sealed) {
+			const CallableHelper* found;
+			if (_lookup_method(methods, "operator new", &found)) {
+				this->sealed_new_impl = found;
+			}
+			if (_lookup_method(methods, "operator ()", &found)) {
+				this->sealed_call_impl = found;
+			}
+			if (_lookup_method(methods, "operator subclassof", &found)) {
+				this->sealed_subclassof_impl = found;
+			}
+			if (_lookup_method(methods, "operator instanceof", &found)) {
+				this->sealed_instanceof_impl = found;
+			}
+		}
+
+		/*
+		Define the field layout for instances. The field areas and cold
+		blocks of the bases come first, with their fields at the same
+		offsets. The fields of the type follow: hot fields first, then
+		normal ones, each group packed to minimize padding. Cold fields
+		are packed into the cold block, allocated separately.
+		*/
 		this->fields = {};
-		this->field_types = {};
+		auto set_field = [this](const std::string& name, const FieldInfo& field) {
+			auto [where, inserted] = this->fields.try_emplace(name, field);
+			if (!inserted) {
+				// the field shadows one of a base.
+				if (where->second.type) {
+					where->second.type->decRef();
+				}
+				where->second = field;
+			}
+		};
+		size_t fields_size = 0;
+		size_t fields_align = alignof(void*);
+		size_t cold_size = 0;
+		size_t cold_align = alignof(void*);
+		std::optional<size_t> cold_slot;
+		std::optional<size_t> dynamic_offset;
+		size_t dynamic_inline = 0;
+		for (Type* base : this->bases) {
+			const InternalAPI::MemoryLayout* base_layout = base->layout;
+			size_t base_start = inthandling::align_up(fields_size, base_layout->fields_align);
+			size_t base_cold_start = inthandling::align_up(cold_size, base_layout->cold_align);
+			for (auto& [name, field] : base->fields) {
+				FieldInfo inherited = field;
+				inherited.offset += inherited.cold ? base_cold_start : base_start;
+				if (inherited.type) {
+					inherited.type->incRef();
+				}
+				set_field(name, inherited);
+			}
+			if (base_layout->cold_size != 0 && !cold_slot) {
+				cold_slot = base_start + base_layout->cold_slot;
+			}
+			if (base->root_shape != nullptr && !dynamic_offset) {
+				dynamic_offset = base_start + base->dynamic_offset;
+				dynamic_inline = base->dynamic_inline;
+			}
+			fields_size = base_start + base_layout->fields_size;
+			fields_align = std::max(fields_align, base_layout->fields_align);
+			cold_size = base_cold_start + base_layout->cold_size;
+			cold_align = std::max(cold_align, base_layout->cold_align);
+		}
+
+		std::vector<std::pair<std::string, FieldInfo>> hot_fields, normal_fields, cold_fields;
 		for (auto& [name, type] : definition.fields) {
-			this->fields[name] = fieldcount++;
-			this->field_types[name] = type;
-			type->incRef();
+			FieldInfo field = { type, 0, sizeof(Object*), alignof(Object*), false, false };
+			if (type != nullptr && type->inplace_size > 0) {
+				field.size = type->inplace_size;
+				field.align = type->inplace_align;
+				field.unboxed = true;
+			}
+			auto hint = definition.field_hints.find(name);
+			switch (hint != definition.field_hints.end() ? hint->second : FieldHint::NORMAL) {
+			case FieldHint::HOT:
+				hot_fields.emplace_back(name, field);
+				break;
+			case FieldHint::COLD:
+				field.cold = true;
+				cold_fields.emplace_back(name, field);
+				break;
+			default:
+				normal_fields.emplace_back(name, field);
+				break;
+			}
+		}
+		_pack_fields(hot_fields, fields_size, fields_align);
+		_pack_fields(normal_fields, fields_size, fields_align);
+		if (definition.dynamic_attributes && !dynamic_offset) {
+			dynamic_offset = inthandling::align_up(fields_size, alignof(_DynamicAttributes));
+			dynamic_inline = definition.inline_attributes;
+			fields_size = *dynamic_offset + sizeof(_DynamicAttributes) + dynamic_inline * sizeof(Object*);
+			fields_align = std::max(fields_align, alignof(_DynamicAttributes));
+		}
+		if (dynamic_offset) {
+			this->root_shape = new Shape();
+			this->dynamic_offset = *dynamic_offset;
+			this->dynamic_inline = dynamic_inline;
+		}
+		if (!cold_fields.empty()) {
+			if (!cold_slot) {
+				cold_slot = inthandling::align_up(fields_size, alignof(void*));
+				fields_size = *cold_slot + sizeof(void*);
+			}
+			_pack_fields(cold_fields, cold_size, cold_align);
+		}
+		for (auto* group : { &hot_fields, &normal_fields, &cold_fields }) {
+			for (auto& [name, field] : *group) {
+				set_field(name, field);  // takes over the reference held by the pending definition
+			}
+		}
+		definition.fields.clear();
+
+		// aligned instances are inherited, and their cold blocks are padded the same way.
+		size_t instance_align = definition.instance_align;
+		for (Type* base : this->bases) {
+			instance_align = std::max(instance_align, base->layout->instance_align);
+		}
+		if (instance_align != 0 && cold_size != 0) {
+			cold_align = std::max(cold_align, instance_align);
+			cold_size = inthandling::align_up(cold_size, instance_align);
 		}
 
-		this->layout = new InternalAPI::MemoryLayout(definition._computeLayout(fieldcount));
+		this->layout = new InternalAPI::MemoryLayout(definition.c_size, definition.c_align, fields_size, fields_align);
+		this->layout->instance_align = instance_align;
+		if (cold_size != 0) {
+			this->layout->cold_size = cold_size;
+			this->layout->cold_align = cold_align;
+			this->layout->cold_slot = *cold_slot;
+		}
+		this->pending = nullptr;
+	}
+	void Type::finalize() const {
+		std::call_once(this->finalized, [this]() {
+			const_cast<Type*>(this)->_finalize();
+		});
 	}
 
 	bool Type::get_method(const char* name, CallableHelper const** out) const {
-		if (this->instance_methods.contains(name)) {
-			*out =  &this->instance_methods.at(name);
+		this->finalize();
+		return _lookup_method(this->methods.load(), name, out);
+	}
+	bool Type::_lookup_method(const _MethodTables* methods, const char* name, CallableHelper const** out) {
+		auto found = methods->instance_methods.find(name);
+		if (found != methods->instance_methods.end()) {
+			*out = &found->second;
 			return true;
 		}
-		if (this->class_methods.contains(name)) {
-			*out = &this->class_methods.at(name);
+		found = methods->class_methods.find(name);
+		if (found != methods->class_methods.end()) {
+			*out = &found->second;
 			return true;
 		}
-		if (this->static_methods.contains(name)) {
-			*out = &this->static_methods.at(name);
+		found = methods->static_methods.find(name);
+		if (found != methods->static_methods.end()) {
+			*out = &found->second;
 			return true;
 		}
 		return false;
@@ -352,10 +769,221 @@ namespace Silicon {
 		*out = meth->bind(instance.operator->());
 		return true;
 	}
+	bool Type::_find_method(const char* name, const CallableHelper* const Type::* sealed_slot, CallableHelper const** out) const {
+		if (this->sealed) {
+			this->finalize();  // slots are resolved upon finalization
+			*out = this->*sealed_slot;
+			return *out != nullptr;
+		}
+		return this->get_method(name, out);
+	}
+	bool Type::is_sealed() const {
+		return this->sealed;
+	}
+	void Type::_patch_method(namedict<CallableHelper> _MethodTables::* table, const char* name, const CallableHelper& method) {
+		if (this->sealed) {
+			throw SiliconException("cannot patch the methods of a sealed type.");
+		}
+		this->finalize();
+		std::lock_guard<std::mutex> lock(this->patch_lock);
+
+		const _MethodTables* old = this->methods.load();
+		_MethodTables* patched = new _MethodTables(*old);
+		(patched->*table)[name] = method;
+
+		// a patched type check can no longer be answered natively.
+		if (table == &_MethodTables::class_methods) {
+			if (std::strcmp(name, "operator subclassof") == 0) {
+				this->native_subclass_check = false;
+			}
+			if (std::strcmp(name, "operator instanceof") == 0) {
+				this->native_instance_check = false;
+			}
+			if (std::strcmp(name, "operator new") == 0) {
+				this->native_new = false;
+			}
+		}
+
+		this->methods = patched;
+		this->version.fetch_add(1, std::memory_order_acq_rel);
+		InternalAPI::retire(const_cast<_MethodTables*>(old), [](void* tables) {
+			delete reinterpret_cast<_MethodTables*>(tables);
+		});
+	}
+	void Type::patch_instance_method(const char* name, const CallableHelper& method) {
+		this->_patch_method(&_MethodTables::instance_methods, name, method);
+	}
+	void Type::patch_class_method(const char* name, const CallableHelper& method) {
+		this->_patch_method(&_MethodTables::class_methods, name, method);
+	}
+	void Type::patch_static_method(const char* name, const CallableHelper& method) {
+		this->_patch_method(&_MethodTables::static_methods, name, method);
+	}
 
 	const InternalAPI::MemoryLayout* Type::get_layout() {
+		this->finalize();
 		return this->layout;
 	}
+	const FieldInfo* Type::get_field_info(const char* name) const {
+		this->finalize();
+		auto found = this->fields.find(name);
+		if (found == this->fields.end()) {
+			return nullptr;
+		}
+		return &found->second;
+	}
+	bool Type::_direct_new(size_t c_size, InternalAPI::MemoryLayout** layout, Allocator** allocator) {
+		this->finalize();
+		if (!this->native_new.load(std::memory_order_relaxed)) {
+			return false;
+		}
+		if (this->layout->c_size != c_size) {
+			throw SiliconException("the type is not bound to a C++ class of that size.");
+		}
+		*layout = this->layout;
+		*allocator = this->allocator;
+		return true;
+	}
+	Allocator* Type::get_allocator() const {
+		return this->allocator;
+	}
+	FieldSlot Type::get_slot(const char* name) {
+		this->finalize();
+		auto field = this->fields.find(name);
+		if (field != this->fields.end()) {
+			return FieldSlot(this, this->layout, &field->second);
+		}
+		auto property = this->properties.find(name);
+		if (property != this->properties.end()) {
+			return FieldSlot(this, &property->second);
+		}
+		if (this->root_shape != nullptr) {
+			return FieldSlot(this, name);
+		}
+		return FieldSlot();
+	}
+	// start of the field area of an instance of exactly this type.
+	void* Type::_fields_of(Object* instance) const {
+		byte* most_derived = reinterpret_cast<byte*>(instance) - this->layout->c_root_offset;
+		return this->layout->fields(most_derived - InternalAPI::MemoryLayout::head_size);
+	}
+	// storage of a field of an instance of exactly this type.
+	void* Type::_field_storage(Object* instance, const FieldInfo& field) const {
+		byte* area = reinterpret_cast<byte*>(this->_fields_of(instance));
+		if (field.cold) {
+			area = *reinterpret_cast<byte**>(area + this->layout->cold_slot);
+		}
+		return area + field.offset;
+	}
+	Ref<Object> Type::_load_field(Object* instance, const FieldInfo& field) const {
+		void* where = this->_field_storage(instance, field);
+		if (field.unboxed) {
+			// boxing only happens here, when a reference is requested.
+			return Object::inplace_load(field.type, where, field.size);
+		}
+		return *reinterpret_cast<Object**>(where);
+	}
+	bool Type::_store_field(Object* instance, const FieldInfo& field, Ref<Object> value) const {
+		if (value == nullptr) {
+			if (field.unboxed) {
+				return false;  // unboxed fields always hold a value.
+			}
+		}
+		else if (field.type != nullptr && !field.type->instance_check(value)) {
+			return false;
+		}
+
+		void* where = this->_field_storage(instance, field);
+		if (field.unboxed) {
+			return field.type->inplace_store(where, field.size, value);
+		}
+		Object*& slot = *reinterpret_cast<Object**>(where);
+		Object* old = slot;
+		slot = value.get();
+		Object::_incRef(slot);
+		Object::_decRef(old);
+		return true;
+	}
+	void Type::_release_fields(Object* instance) {
+		if (this->layout == nullptr) {
+			return;  // never finalized, so it has no instances with fields.
+		}
+		for (auto& [name, field] : this->fields) {
+			if (field.unboxed) {
+				continue;
+			}
+			Object*& slot = *reinterpret_cast<Object**>(this->_field_storage(instance, field));
+			Object::_decRef(slot);
+			slot = nullptr;
+		}
+		if (this->root_shape != nullptr) {
+			_DynamicAttributes* storage = this->_dynamic_of(instance);
+			size_t count = storage->shape ? storage->shape->size() : 0;
+			for (size_t i = 0; i < count; i++) {
+				Object*& slot = i < this->dynamic_inline ? storage->inline_values()[i] : storage->overflow[i - this->dynamic_inline];
+				Object::_decRef(slot);
+				slot = nullptr;
+			}
+			delete[] storage->overflow;
+			storage->overflow = nullptr;
+			storage->shape = nullptr;
+		}
+	}
+	// capacity of the overflow array of an instance holding count overflowing attributes.
+	static size_t _overflow_capacity(size_t count) {
+		return count == 0 ? 0 : std::max<size_t>(4, std::bit_ceil(count));
+	}
+	Type::_DynamicAttributes* Type::_dynamic_of(Object* instance) const {
+		return reinterpret_cast<_DynamicAttributes*>(reinterpret_cast<byte*>(this->_fields_of(instance)) + this->dynamic_offset);
+	}
+	const Shape* Type::_shape_of(Object* instance) const {
+		const Shape* shape = this->_dynamic_of(instance)->shape;
+		return shape ? shape : this->root_shape;
+	}
+	Object** Type::_dynamic_at(Object* instance, size_t index) const {
+		_DynamicAttributes* storage = this->_dynamic_of(instance);
+		if (index < this->dynamic_inline) {
+			return &storage->inline_values()[index];
+		}
+		return &storage->overflow[index - this->dynamic_inline];
+	}
+	Object** Type::_dynamic_slot(Object* instance, const char* name, bool add) {
+		if (this->root_shape == nullptr) {
+			return nullptr;
+		}
+		_DynamicAttributes* storage = this->_dynamic_of(instance);
+		const Shape* shape = storage->shape ? storage->shape : this->root_shape;
+		size_t index;
+		if (!shape->find(name, &index)) {
+			if (!add) {
+				return nullptr;
+			}
+			index = shape->size();
+			if (index >= this->dynamic_inline) {
+				// grow the overflow array by doubling its capacity.
+				size_t used = index - this->dynamic_inline;
+				if (used == _overflow_capacity(used)) {
+					Object** overflow = new Object*[std::max<size_t>(4, used * 2)]();
+					std::copy(storage->overflow, storage->overflow + used, overflow);
+					delete[] storage->overflow;
+					storage->overflow = overflow;
+				}
+			}
+			storage->shape = shape->with(name);
+		}
+		return this->_dynamic_at(instance, index);
+	}
+	bool Type::_set_dynamic(Object* instance, const char* name, Object* value) {
+		Object** slot = this->_dynamic_slot(instance, name, value != nullptr);
+		if (slot == nullptr) {
+			return value == nullptr && this->root_shape != nullptr;  // unsetting a missing attribute.
+		}
+		Object* old = *slot;
+		*slot = value;
+		Object::_incRef(value);
+		Object::_decRef(old);
+		return true;
+	}
 	bool Type::supports_inplace_storage() const {
 		return this->inplace_writer && this->inplace_reader;
 	}
@@ -365,19 +993,75 @@ namespace Silicon {
 	Ref<Object> Type::inplace_load(void* where, size_t available_space) {
 		return this->inplace_reader(where, available_space);
 	}
+	size_t Type::inplace_store_batch(void* where, size_t stride, Object* const* values, size_t count) {
+		if (this->inplace_batch_writer) {
+			return this->inplace_batch_writer(where, stride, values, count);
+		}
+		byte* slot = reinterpret_cast<byte*>(where);
+		for (size_t i = 0; i < count; i++, slot += stride) {
+			if (!this->inplace_writer(slot, stride, values[i])) {
+				return i;
+			}
+		}
+		return count;
+	}
+	void Type::inplace_load_batch(const void* where, size_t stride, Object** values, size_t count) {
+		if (this->inplace_batch_reader) {
+			this->inplace_batch_reader(where, stride, values, count);
+			return;
+		}
+		byte* slot = const_cast<byte*>(reinterpret_cast<const byte*>(where));
+		for (size_t i = 0; i < count; i++, slot += stride) {
+			values[i] = this->inplace_reader(slot, stride);
+		}
+	}
+	bool Type::_native_subclass_check(Type* subclass) const {
+		if (subclass == nullptr) {
+			return false;
+		}
+		if (this == subclass) {
+			return true;
+		}
+		for (Type* base : subclass->bases) {
+			if (this->_native_subclass_check(base)) {
+				return true;
+			}
+		}
+		return false;
+	}
 	bool Type::subclass_check(Ref<Type> subclass) {
-		BoundCallableHelper impl;
-		if (!this->get_method("operator subclassof", this, &impl)) {
+		// the flag is final once the type has inherited the methods of its bases.
+		this->finalize();
+		if (this->native_subclass_check) {
+			return this->_native_subclass_check(subclass.operator->());
+		}
+		_DispatchGuard guard(this);
+		const CallableHelper* impl;
+		if (!this->_find_method("operator subclassof", &Type::sealed_subclassof_impl, &impl)) {
 			throw SiliconException(nullptr);
 		}
-		return (bool)impl({ subclass }, {});
+		// the check is the boundary: errors of the implementation are thrown from here.
+		Object* argv[2] = { nullptr, subclass.get() };
+		Ref<Object> result = impl->bind(this).vectorcall(ArgVector(argv + 1, 1, {}, true));
+		return Immediate::truth(result.get());
 	}
 	bool Type::instance_check(Ref<Object> instance) {
-		BoundCallableHelper impl;
-		if (!this->get_method("operator instanceof", this,&impl)) {
+		this->finalize();
+		if (this->native_instance_check) {
+			// same as Object's "operator instanceof", without building an argument list.
+			if (instance == nullptr) {
+				return false;
+			}
+			return this->subclass_check(type_of(instance.get()));
+		}
+		_DispatchGuard guard(this);
+		const CallableHelper* impl;
+		if (!this->_find_method("operator instanceof", &Type::sealed_instanceof_impl, &impl)) {
 			throw SiliconException(nullptr);
 		}
-		return (bool)impl({ instance }, {});
+		Object* argv[2] = { nullptr, instance.get() };
+		Ref<Object> result = impl->bind(this).vectorcall(ArgVector(argv + 1, 1, {}, true));
+		return Immediate::truth(result.get());
 	}
 	std::vector<Ref<Type>> Type::getBases() {
 		std::vector<Ref<Type>> result{};
@@ -394,12 +1078,25 @@ namespace Silicon {
 				base = nullptr;
 			}
 		}
-		for (auto& [name, type] : this->field_types) {
-			if (type) {
-				type->decRef();
-				type = nullptr;
+		for (auto& [name, field] : this->fields) {
+			if (field.type) {
+				field.type->decRef();
+				field.type = nullptr;
+			}
+		}
+		if (this->pending) {
+			// the type was never finalized, field types are still referenced by its definition.
+			for (auto& [name, type] : this->pending->fields) {
+				if (type) {
+					type->decRef();
+				}
 			}
+			this->pending = nullptr;
 		}
+		delete this->root_shape;
+		this->root_shape = nullptr;
+		delete this->methods.load();
+		this->methods = nullptr;
 		if (this->layout) {
 			delete this->layout;
 			this->layout = nullptr;
@@ -411,7 +1108,7 @@ namespace Silicon {
 			return true;
 		}
 		for (auto base : subclass->getBases()) {
-			if (_basic_subclasscheck(base, subclass)) {
+			if (_basic_subclasscheck(cls, base)) {
 				return true;
 			}
 		}
@@ -419,113 +1116,104 @@ namespace Silicon {
 	}
 
 	bool _basic_instancecheck(Ref<Type> cls, Ref<Object> instance) {
-		return _basic_subclasscheck(cls, instance->getType());
+		return _basic_subclasscheck(cls, type_of(instance.get()));
 	}
 
 
-	_dummy TypeSystemRoot::init() {
+	Ref<Object> _object_new(Type* cls) {
+		auto mem = InternalAPI::ObjectMemory::allocate(cls->get_layout(), nullptr, cls->get_allocator());
+		return Immediate::from_address(mem.most_derived());
+	}
+	void _object_init(Object* self, Type* type) {
+		// call_cpp_ctor(args[0], Object, args[1].DownCast<Type>().operator->());
+		//call_cpp_ctor(args[0].operator->(), (Type*)nullptr);
+	}
+	void _object_free(Type* cls, Object* instance) {
+		auto mem = InternalAPI::ObjectMemory::from_thisptr(instance);
+		mem.free();
+	}
+	void _type_init(Object* self, Object* definition, Type* metatype) {
+		// to do: call self->Type::Type(definition, metatype)
+	}
 
-		std::cout << std::hash<std::string>()("operator instanceof") << '\n';
-		std::cout << std::hash<std::string>()("operator free") << '\n';
 
-		_current = new TypeSystemRoot();
+	// in-place representations of immediates.
+	struct _IntCodec {
+		using storage_type = intptr_t;
 
-		for (size_t i = 0; i < totalsizeof_type; i++) {
-			object_type_memory[i] = 0_b;
+		static inline bool encode(Object* value, intptr_t& storage) {
+			if (!Immediate::is_int(value)) {
+				return false;
+			}
+			storage = Immediate::to_int(value);
+			return true;
 		}
-		for (size_t i = 0; i < totalsizeof_type; i++) {
-			
+		static inline Object* decode(const intptr_t& storage) {
+			return Immediate::from_int(storage);
 		}
+	};
+	struct _BoolCodec {
+		using storage_type = bool;
 
-		_current->_object_type = reinterpret_cast<Type*>(InternalAPI::ObjectMemory::at(_current->_object_type_address).most_derived());
-		_current->_type_type = reinterpret_cast<Type*>(InternalAPI::ObjectMemory::at(_current->_type_type_address).most_derived());
+		static inline bool encode(Object* value, bool& storage) {
+			if (!Immediate::is_bool(value)) {
+				return false;
+			}
+			storage = value == Immediate::true_value();
+			return true;
+		}
+		static inline Object* decode(const bool& storage) {
+			return Immediate::from_bool(storage);
+		}
+	};
 
+	_dummy TypeSystemRoot::init() {
+
+		Type* _object_type = &object_type_image.object;
+		Type* _type_type = &type_type_image.object;
 
 		auto object_typedef = TypeDef("Object", {});
 		object_typedef.bindCppType<Object>();
 
-		object_typedef.new_impl = [](args_t args, kwds_t kwds) -> Ref<Object> {
-			Ref<Object> exc;
-			if (!CallableHelper::typeCheckArgs(args, { typeof<Type> }, &exc)) {
-				throw SiliconException(exc);
-			}
-			if (!CallableHelper::typeCheckKwds(kwds, {}, &exc)) {
-				throw SiliconException(exc);
+		object_typedef.new_impl = NativeMethod<&_object_new>::callable();
+		object_typedef.init_impl = NativeMethod<&_object_init>::callable();
+		object_typedef.subclassof_impl = [](ArgVector args) -> CallResult {
+			// built upon the first call, once the root types are.
+			static const Signature signature({ { typeof<Type> }, { typeof<Type> } });
+			if (const CallError* error = signature.check(args)) {
+				return *error;
 			}
-			Ref<Type> cls = args[0].DownCast<Type>();
 
-			auto mem = InternalAPI::ObjectMemory::allocate(cls->get_layout(), nullptr, nullptr);
-
-			return nullptr;
-		};
-		object_typedef.init_impl = [](args_t args, kwds_t kwds) -> Ref<Object> {
-			Ref<Object> exc;
-			if (!CallableHelper::typeCheckArgs(args, { typeof<Object>, typeof<Type> }, &exc)) {
-				throw SiliconException(exc);
-			}
-			if (!CallableHelper::typeCheckKwds(kwds, {}, &exc)) {
-				throw SiliconException(exc);
-			}
-			// call_cpp_ctor(args[0], Object, args[1].DownCast<Type>().operator->());
-			//call_cpp_ctor(args[0].operator->(), (Type*)nullptr);
-			return nullptr;
-		};
-		object_typedef.subclassof_impl = [](args_t args, kwds_t kwds) -> Ref<Object> {
-			if (args.size() != 2) {
-				return nullptr;  // should throw SiliconException in the future.
-			}
-			if (kwds.size()) {
-				return nullptr;  // same as above
-			}
-			if (!_basic_instancecheck(typeof<Type>, args[0])) {
-				return nullptr;  // same
-			}
-			if (!_basic_instancecheck(typeof<Type>, args[1])) {
-				return nullptr;  // same
-			}
-
-			auto cls = args[0].DownCast<Type>();
-			auto other = args[1].DownCast<Type>();
+			Ref<Type> cls = static_cast<Type*>(args[0]);
+			Ref<Type> other = static_cast<Type*>(args[1]);
 
 			if (cls.is(other)) {
-				return other;  // synonym of true for now, until BoolObject is implemented
+				return Ref<Object>(Immediate::true_value());
 			}
 			
 			for (Ref<Type> tp : other->getBases()) {
 				if (cls->subclass_check(tp)) {
-					return other;  // same as above.
+					return Ref<Object>(Immediate::true_value());
 				}
 			}
-			return nullptr;  // needs to be replaced with BoolObject later
+			return Ref<Object>(Immediate::false_value());
 		};
-		object_typedef.instanceof_impl = [](args_t args, kwds_t kwds) -> Ref<Object> {
+		object_typedef.instanceof_impl = [](ArgVector args) -> CallResult {
 			if (args.size() != 2) {
-				return nullptr;  // should throw SiliconException in the future.
+				return CallError::wrong_arity;
 			}
-			if (kwds.size()) {
-				return nullptr;  // same as above
+			if (args.kwd_names().size()) {
+				return CallError::unexpected_keyword;
 			}
-			if (!_basic_instancecheck(typeof<Type>, args[0])) {
-				return nullptr; // same
+			if (args[0] == nullptr || !_basic_instancecheck(typeof<Type>, args[0])) {
+				return CallError::wrong_type;
 			}
 
-			auto cls = args[0].DownCast<Type>();
-			auto instance = args[1];
-
-			return cls->subclass_check(instance->getType()) ? instance : nullptr;  // needs to be replaced with BoolObject later
-		};
-		object_typedef.free_impl = [](args_t args, kwds_t kwds) -> Ref<Object> {
-			Ref<Object> exc;
-			if (!CallableHelper::typeCheckArgs(args, { typeof<Type>,  typeof<Object> }, &exc)) {
-				throw SiliconException(exc);
-			}
-			if (!CallableHelper::typeCheckKwds(kwds, {}, &exc)) {
-				throw SiliconException(exc);
-			}
-			auto mem = InternalAPI::ObjectMemory::from_thisptr(args[1].operator->());
-			mem.free();
-			return nullptr;
+			Ref<Type> cls = static_cast<Type*>(args[0]);
+			Object* instance = args[1];
+			return Ref<Object>(Immediate::from_bool(instance != nullptr && cls->subclass_check(type_of(instance))));
 		};
+		object_typedef.free_impl = NativeMethod<&_object_free>::callable();
 
 		/*
 		Default behaviour of inplace storage. This function is only used upon calls
@@ -548,36 +1236,59 @@ namespace Silicon {
 			return *addr;
 		};
 
-		auto type_typedef = TypeDef("Type", { _current->_object_type });
+		auto type_typedef = TypeDef("Type", { _object_type });
 		type_typedef.bindCppType<Type>();
 
-		type_typedef.init_impl = [](args_t args, kwds_t kwds) -> Ref<Object> {
-			Ref<Object> exc;
-			if (!CallableHelper::typeCheckArgs(args, { typeof<Object>, typeof<Object>, typeof<Type> }, &exc)) {
-				throw SiliconException(exc);
-			}
-			if (!CallableHelper::typeCheckKwds(kwds, {}, &exc)) {
-				throw SiliconException(exc);
-			}
-			// to do: call args[0]->Type::Type(args[1], args[2])
-			return nullptr;
-		};
+		type_typedef.init_impl = NativeMethod<&_type_init>::callable();
 
-		_current->_object_type = new(_current->_object_type_address, nullptr, nullptr) Type(object_typedef, _current->_type_type);
-		_current->_type_type = new(_current->_type_type_address, nullptr, nullptr) Type(type_typedef, _current->_type_type);
+		new(&object_type_image, nullptr, nullptr) Type(object_typedef, _type_type);
+		// Object provides the default type checks, which are answered natively from now on.
+		_object_type->native_subclass_check = true;
+		_object_type->native_instance_check = true;
+		_object_type->native_new = true;
+		new(&type_type_image, nullptr, nullptr) Type(type_typedef, _type_type);
 
+		/*
+		Types of immediate values. Immediates are stored unboxed in fields
+		of these types, as their value rather than as tagged pointers.
+		*/
+		auto int_typedef = TypeDef("int", { _object_type });
+		int_typedef.sealed = true;
+		int_typedef.setInplaceCodec<_IntCodec>();
+		new(&int_type_image, nullptr, nullptr) Type(int_typedef, _type_type);
+
+		auto bool_typedef = TypeDef("bool", { _object_type });
+		bool_typedef.sealed = true;
+		bool_typedef.setInplaceCodec<_BoolCodec>();
+		new(&bool_type_image, nullptr, nullptr) Type(bool_typedef, _type_type);
+
+		auto none_typedef = TypeDef("NoneType", { _object_type });
+		none_typedef.sealed = true;
+		new(&none_type_image, nullptr, nullptr) Type(none_typedef, _type_type);
 
-		object_type = _current->_object_type;
-		type_type = _current->_type_type;
 
-		delete _current;
-		_current = nullptr;
+		object_type = _object_type;
+		type_type = _type_type;
 		return (_dummy)0;
 	}
 	_dummy TypeSystemRoot::dummy = init();
 
-	Type* Object::typeObject = TypeSystemRoot::object_type;
-	Type* Type::typeObject = TypeSystemRoot::type_type;
+	// constant-initialized, so these are valid regardless of the order of static initialization.
+	constinit Type* Object::typeObject = &object_type_image.object;
+	constinit Type* Type::typeObject = &type_type_image.object;
+	constinit Type* Immediate::int_type = &int_type_image.object;
+	constinit Type* Immediate::bool_type = &bool_type_image.object;
+	constinit Type* Immediate::none_type = &none_type_image.object;
+
+	Type* Immediate::type_of(const Object* value) {
+		if (is_int(value)) {
+			return int_type;
+		}
+		if (is_bool(value)) {
+			return bool_type;
+		}
+		return none_type;
+	}
 
 
 	/*TYPEOBJ(MemoryAddressObject) {
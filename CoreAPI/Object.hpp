@@ -2,8 +2,14 @@
 #include "Forward.hpp"
 #include "cstdint"
 #include "CallableHelper.hpp"
+#include "Immediate.hpp"
+#include "Inplace.hpp"
 #include "../macros.hpp"
+#include "../InternalAPI/Epoch.hpp"
 #include <string>
+#include <optional>
+#include <atomic>
+#include <mutex>
 
 
 //#define call_cpp_ctor(obj, type, ...) obj->type::type(__VA_ARGS__)
@@ -40,6 +46,13 @@ namespace Silicon {
 	};
 
 
+	/*
+	Immediate values (see Immediate) are passed as Object* but are not
+	allocated objects: the member functions of Object must only be called
+	on allocated ones, which raw Object* APIs do not check. Values that
+	may be immediates are handled by Ref, by type_of() and by the other
+	free functions that accept them.
+	*/
 	class Object {
 	private:
 
@@ -48,9 +61,14 @@ namespace Silicon {
 		friend class CallableHelper;
 		friend class BoundCallableHelper;
 		friend class BoundPropertyHelper;
+		friend class ObjectArray;
+		friend class FieldSlot;
 
 		template<class T, class TArgs>
 		friend void call_cpp_ctor(T*, TArgs...);
+		template<complete_obj_class T, class ...TArgs>
+			requires std::constructible_from<T, TArgs...>
+		friend Ref<T> make(TArgs&&... args);
 
 		template<object_class T>
 		friend class Ref;
@@ -60,9 +78,21 @@ namespace Silicon {
 
 		void incRef();
 		void decRef();
+		// reference counting of any value: nothing is done for nullptr and immediates.
+		static inline void _incRef(Object* value) {
+			if (value != nullptr && !Immediate::is_immediate(value)) {
+				value->incRef();
+			}
+		}
+		static inline void _decRef(Object* value) {
+			if (value != nullptr && !Immediate::is_immediate(value)) {
+				value->decRef();
+			}
+		}
 
 
 		void __call_ctor__(Type* rtti);
+		void* _field_address(const char* name, size_t size, size_t align);
 
 	protected:
 		Object(Type* rtti);
@@ -78,6 +108,7 @@ namespace Silicon {
 		Object(const Object&) = delete;
 		Object& operator =(const Object&) = delete;
 		// static Object* create(Type* rtti, Allocator* allocator = nullptr);
+		// requires an allocated object, see type_of() for any value.
 		Type* getType();
 		/*
 		Store an object in-place at the specified location, given the
@@ -98,11 +129,77 @@ namespace Silicon {
 		*/
 		static Object* inplace_load(Type* rtti, void* where, size_t available_space);
 
+		/*
+		Typed access to an unboxed field: returns the address of its
+		storage, or nullptr if the object has no unboxed field of that
+		name whose size and alignment match T.
+		*/
+		template<class T>
+			requires std::is_trivially_copyable_v<T>
+		inline T* field(const char* name) {
+			return static_cast<T*>(this->_field_address(name, sizeof(T), alignof(T)));
+		}
+		/*
+		Read a field as an object. Unboxed fields are boxed upon each call.
+		Returns nullptr if the field is not set or does not exist.
+		*/
+		Ref<Object> get_field(const char* name);
+		/*
+		Write a field. Returns false if the object has no such field, if
+		the value is not an instance of the type of the field, or if the
+		value of an unboxed field could not be stored in place.
+		*/
+		bool set_field(const char* name, Ref<Object> value);
+		/*
+		Read or write an attribute: a field if the type declares one of
+		that name, a dynamic attribute of the instance otherwise (see
+		TypeDef::dynamic_attributes). Setting a dynamic attribute adds it
+		if the instance does not have it yet. Dynamic attributes cannot be
+		removed; setting one to nullptr unsets it.
+		*/
+		Ref<Object> get_attribute(const char* name);
+		bool set_attribute(const char* name, Ref<Object> value);
+
 		virtual ~Object();
 		void operator delete(void*);
+		void operator delete(void*, Type*);
 		void operator delete(void*, void*, InternalAPI::MemoryLayout*, Allocator*);
 	};
 
+	// type of any value: immediates are typed by their tag. Requires a value other than nullptr.
+	inline Type* type_of(Object* value) {
+		if (Immediate::is_immediate(value)) {
+			return Immediate::type_of(value);
+		}
+		return value->getType();
+	}
+
+	/*
+	Storage of a field within the field area of instances. Fields of
+	types with an in-place representation (see TypeDef::inplace_size)
+	are stored unboxed, other fields as a reference to an object.
+	*/
+	struct FieldInfo {
+		Type* type;  // nullptr if the field accepts any object.
+		size_t offset;  // from the start of the field area.
+		size_t size;
+		size_t align;
+		bool unboxed;
+		bool cold;  // stored in the cold block of instances rather than in their field area.
+	};
+
+	/*
+	How often a field is expected to be accessed. Hot fields are placed
+	first, right after the C data, and cold fields in a block allocated
+	separately, so that the frequently accessed part of instances spans
+	fewer cache lines.
+	*/
+	enum class FieldHint : uint8_t {
+		NORMAL,
+		HOT,
+		COLD
+	};
+
 	class _TypeMethodDefHelper {
 		namedict<CallableHelper>& target;
 		const char* method_name;
@@ -111,6 +208,7 @@ namespace Silicon {
 		_TypeMethodDefHelper(namedict<CallableHelper>&, const char*);
 		CallableHelper& operator =(CallableHelper&) const;
 		CallableHelper& operator =(CallableHelper::functype) const;
+		CallableHelper& operator =(CallableHelper::vectorfunc) const;
 	};
 
 
@@ -131,6 +229,7 @@ namespace Silicon {
 		namedict<CallableHelper> class_methods;
 		namedict<CallableHelper> static_methods;
 		namedict<Type*> fields;
+		namedict<FieldHint> field_hints;
 		namedict<PropertyHelper> properties;
 		size_t c_size;
 		size_t c_align;
@@ -146,8 +245,49 @@ namespace Silicon {
 		const _TypeMethodDefHelper member_impl;
 		const _TypeMethodDefHelper subclassof_impl;
 		const _TypeMethodDefHelper instanceof_impl;
-		std::function<bool(void*, size_t, Object*)> inplace_write;
-		std::function<Object* (void*, size_t)> inplace_read;
+		/*
+		In-place storage functions. The batch functions are optional: arrays
+		of values are converted one by one with the other two otherwise.
+		*/
+		inplace_write_fn inplace_write;
+		inplace_read_fn inplace_read;
+		inplace_write_batch_fn inplace_write_batch;
+		inplace_read_batch_fn inplace_read_batch;
+		/*
+		Size and alignment of the in-place representation of instances,
+		or 0 if it has no fixed size. Fields of types with a fixed size
+		in-place representation are stored unboxed in their instances.
+		*/
+		size_t inplace_size;
+		size_t inplace_align;
+		/*
+		A sealed type cannot be subclassed, and its methods cannot be
+		patched once it is built. This lets the runtime resolve its
+		special methods only once, upon finalization. Other methods and
+		accessors are resolved once by their callers, with MethodCache,
+		AttributeCache or Type::get_slot(): for sealed types, what they
+		resolve never goes stale, and is used without any EpochGuard.
+		*/
+		bool sealed;
+		/*
+		Alignment of whole instances, usually the size of a cache line (64,
+		or 128 on some processors), or 0 for the default. Instances are
+		allocated on such a boundary and padded to a multiple of it, so that
+		instances updated by different threads never share a cache line.
+		Must be a power of two, and is inherited by subclasses.
+		*/
+		size_t instance_align;
+		/*
+		Let instances hold attributes besides their declared fields. The
+		names of such attributes are described by shapes shared between
+		instances (see Shape), and only their values are stored in each
+		instance: the first inline_attributes ones in its field area, the
+		others in an overflow array. Inherited by subclasses.
+		*/
+		bool dynamic_attributes;
+		size_t inline_attributes;
+		// allocator of the instances of this type, or nullptr for the default one.
+		Allocator* allocator;
 		// ...
 		TypeDef(const char* name, std::vector<Type*> bases);
 
@@ -157,13 +297,30 @@ namespace Silicon {
 		inline void bindCppType() {
 			this->_bindCppType(sizeof(T), alignof(T));
 		}
+		// set all the in-place storage functions, size and alignment from a codec.
+		template<inplace_codec TCodec>
+		inline void setInplaceCodec() {
+			this->inplace_write = &inplace_traits<TCodec>::write;
+			this->inplace_read = &inplace_traits<TCodec>::read;
+			this->inplace_write_batch = &inplace_traits<TCodec>::write_batch;
+			this->inplace_read_batch = &inplace_traits<TCodec>::read_batch;
+			this->inplace_size = inplace_traits<TCodec>::size;
+			this->inplace_align = inplace_traits<TCodec>::align;
+		}
 		bool addInstanceMethod(const char* name, CallableHelper& func);
 		bool addInstanceMethod(const char* name, CallableHelper::functype func);
-		bool addField(const char* name, Type* type);
+		bool addInstanceMethod(const char* name, CallableHelper::vectorfunc func);
+		bool addField(const char* name, Type* type, FieldHint hint = FieldHint::NORMAL);
+		bool setFieldHint(const char* name, FieldHint hint);
+		/*
+		Set the hints of all the fields from the number of accesses to each
+		of them, for instance as measured by a profiling run: fields
+		accessed at least half as often as the most accessed one are hot,
+		fields accessed less than 1/64 as often are cold.
+		*/
+		void applyFieldProfile(const namedict<uint64_t>& access_counts);
 		PropertyHelper& addProperty(const char* name, CallableHelper getter = nullptr);
 
-		InternalAPI::MemoryLayout _computeLayout(uint16_t);
-
 		Type* build();
 
 		~TypeDef();
@@ -171,19 +328,111 @@ namespace Silicon {
 
 	class Type : public Object {
 		friend class Object;
+		friend class CallableHelper;
+		friend class ObjectArray;
+		friend class FieldSlot;
+		friend struct TypeSystemRoot;
+		template<complete_obj_class T, class ...TArgs>
+			requires std::constructible_from<T, TArgs...>
+		friend Ref<T> make(TArgs&&... args);
 
 		const char* name;
 		std::vector<Type*> bases;
-		namedict<CallableHelper> instance_methods;
-		namedict<CallableHelper> class_methods;
-		namedict<CallableHelper> static_methods;
-		namedict<Type*> field_types;
-		namedict<size_t> fields;
+
+		/*
+		Method tables of the type. A published table is never modified:
+		patching a method publishes a new table and retires the old one,
+		which is reclaimed once no reader can still observe it.
+		*/
+		struct _MethodTables {
+			namedict<CallableHelper> instance_methods;
+			namedict<CallableHelper> class_methods;
+			namedict<CallableHelper> static_methods;
+		};
+		std::atomic<const _MethodTables*> methods;
+		// incremented each time a method table is published after finalization.
+		std::atomic<uint32_t> version;
+		std::mutex patch_lock;
+
+		namedict<FieldInfo> fields;  // fields of the bases included.
 		namedict<Object*> static_fields;
 		namedict<PropertyHelper> properties;
-		std::function<bool(void*, size_t, Object*)> inplace_writer;
-		std::function<Object* (void*, size_t)> inplace_reader;
+		inplace_write_fn inplace_writer;
+		inplace_read_fn inplace_reader;
+		inplace_write_batch_fn inplace_batch_writer;
+		inplace_read_batch_fn inplace_batch_reader;
+		size_t inplace_size;
+		size_t inplace_align;
 		InternalAPI::MemoryLayout* layout;
+		/*
+		Storage of dynamic attributes in the field area of instances, at
+		dynamic_offset: see _DynamicAttributes. root_shape is nullptr if
+		instances have no dynamic attributes.
+		*/
+		struct _DynamicAttributes;
+		Shape* root_shape;
+		size_t dynamic_offset;
+		size_t dynamic_inline;
+		/*
+		Set when "operator subclassof" and "operator instanceof" are
+		inherited unchanged from Object. Such checks are answered
+		natively instead of being dispatched through the method tables.
+		*/
+		std::atomic<bool> native_subclass_check;
+		std::atomic<bool> native_instance_check;
+		/*
+		Set when "operator new" is inherited unchanged from Object, so that
+		instances can be allocated directly from the layout of the type.
+		*/
+		std::atomic<bool> native_new;
+		Allocator* allocator;
+
+		bool _native_subclass_check(Type* subclass) const;
+		void _patch_method(namedict<CallableHelper> _MethodTables::* table, const char* name, const CallableHelper& method);
+
+		/*
+		Methods of a sealed type never change, so the special methods used
+		by the runtime itself are resolved once upon finalization, and
+		called without any further lookup. User methods are not resolved
+		here: the call sites that use them cache them (see MethodCache).
+		*/
+		bool sealed;
+		const CallableHelper* sealed_new_impl;
+		const CallableHelper* sealed_call_impl;
+		const CallableHelper* sealed_subclassof_impl;
+		const CallableHelper* sealed_instanceof_impl;
+
+		// find a special method, through its resolved slot if the type is sealed.
+		bool _find_method(const char* name, const CallableHelper* const Type::* sealed_slot, OUT CallableHelper const**) const;
+		static bool _lookup_method(const _MethodTables* methods, const char* name, OUT CallableHelper const**);
+
+		struct _PendingDef;
+		// definition of the type, until it is finalized.
+		std::unique_ptr<_PendingDef> pending;
+		mutable std::once_flag finalized;
+
+		void _finalize();
+		void* _fields_of(Object* instance) const;
+		void* _field_storage(Object* instance, const FieldInfo& field) const;
+		// read or write a field of an instance, as Object::get_field and Object::set_field.
+		Ref<Object> _load_field(Object* instance, const FieldInfo& field) const;
+		bool _store_field(Object* instance, const FieldInfo& field, Ref<Object> value) const;
+		// release the references held by the boxed fields of an instance.
+		void _release_fields(Object* instance);
+		_DynamicAttributes* _dynamic_of(Object* instance) const;
+		const Shape* _shape_of(Object* instance) const;
+		// storage of the dynamic attribute of an instance at an index of its shape.
+		Object** _dynamic_at(Object* instance, size_t index) const;
+		// storage of a dynamic attribute of an instance, added if requested. nullptr if missing.
+		Object** _dynamic_slot(Object* instance, const char* name, bool add);
+		// as Object::set_attribute, for an attribute that is not a field.
+		bool _set_dynamic(Object* instance, const char* name, Object* value);
+		/*
+		Layout and allocator for allocating an instance directly, without
+		dispatching "operator new", given the size of the C++ class it is
+		constructed as. Returns false if the type overrides "operator new".
+		*/
+		bool _direct_new(size_t c_size, OUT InternalAPI::MemoryLayout** layout, OUT Allocator** allocator);
 
 	public:
 
@@ -196,16 +445,87 @@ namespace Silicon {
 		Type(const Type&) = delete;
 		Type& operator =(const Type&) = delete;
 
+		/*
+		Merge the method tables of the bases, assign field indices and
+		compute the memory layout of instances. This happens only once,
+		and is done implicitly upon the first use of the type.
+		Thread-safe.
+		*/
+		void finalize() const;
+		/*
+		Look up a method of this type. Lookups never block, even while
+		another thread patches the type. If the type may be patched
+		concurrently, the caller must hold an InternalAPI::EpochGuard
+		for as long as it uses the method that was found.
+		*/
 		bool get_method(const char* name, OUT CallableHelper const**) const;
 		bool get_method(const char* name, Ref<Object> owner, OUT BoundCallableHelper*) const;
+		/*
+		Add or replace a method of this type, while other threads may be
+		using it. Readers keep seeing the previous method table until the
+		new one is published. Patches only apply to this type and to the
+		subclasses finalized afterwards: subclasses that are already
+		finalized keep the methods they inherited, as well as the native
+		type checks and allocation that come with them, and their version
+		is unchanged.
+		*/
+		void patch_instance_method(const char* name, const CallableHelper& method);
+		void patch_class_method(const char* name, const CallableHelper& method);
+		void patch_static_method(const char* name, const CallableHelper& method);
+		bool is_sealed() const;
+		/*
+		Version of the methods of this type: it changes whenever a method
+		is patched, so that a method found earlier can be reused as long
+		as the version is unchanged.
+		*/
+		inline uint32_t get_version() const {
+			return this->version.load(std::memory_order_acquire);
+		}
+		// storage of a field of instances, or nullptr if there is no such field.
+		const FieldInfo* get_field_info(const char* name) const;
+		/*
+		Resolve a field or property of instances into a slot giving direct
+		access to it, see FieldSlot. Fields take precedence over properties
+		of the same name. If there is neither, the slot accesses the dynamic
+		attribute of that name for types that have dynamic attributes, and
+		resolves to nothing otherwise.
+		*/
+		FieldSlot get_slot(const char* name);
 		bool supports_inplace_storage() const;
 		bool inplace_store(void* where, size_t available_space, Ref<Object> obj);
 		Ref<Object> inplace_load(void* where, size_t available_space);
+		/*
+		Store or load count values in slots stride bytes apart, each slot
+		holding the in-place representation of one value. Values are not
+		type-checked beyond what the codec of the type rejects. Returns the
+		number of values stored, which is less than count if one of them
+		could not be represented.
+		*/
+		size_t inplace_store_batch(void* where, size_t stride, Object* const* values, size_t count);
+		void inplace_load_batch(const void* where, size_t stride, Object** values, size_t count);
 		bool subclass_check(Ref<Type> subclass);
 		bool instance_check(Ref<Object> instance);
 		std::vector<Ref<Type>> getBases();
 		~Type();
 		const InternalAPI::MemoryLayout* get_layout();
+		// allocator of instances, or nullptr for the default one.
+		Allocator* get_allocator() const;
+	};
+
+
+	/*
+	Pins the calling thread for the duration of a method dispatch on a type,
+	unless the type is sealed and its methods can therefore not be retired.
+	*/
+	class _DispatchGuard {
+		std::optional<InternalAPI::EpochGuard> guard;
+
+	public:
+		inline _DispatchGuard(const Type* type) {
+			if (!type->is_sealed()) {
+				this->guard.emplace();
+			}
+		}
 	};
 
 
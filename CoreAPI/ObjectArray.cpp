@@ -0,0 +1,211 @@
+#include "ObjectArray.hpp"
+#include "../InternalAPI/ObjectMemory.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <new>
+
+
+namespace Silicon {
+
+	// columns are aligned on cache lines, so that scans can use aligned vector loads.
+	static constexpr size_t _column_align = 64;
+
+	ObjectArray::ObjectArray(Ref<Type> type, size_t count) :
+		type(type), columns(), count(0), capacity(0)
+	{
+		if (type == nullptr) {
+			throw SiliconException("an object array needs a type.");
+		}
+		type->finalize();
+		for (auto& [name, field] : type->fields) {
+			size_t stride = inthandling::align_up(field.size, field.align);
+			this->columns[name] = _Column{ field, stride, nullptr };
+		}
+		this->resize(count);
+	}
+	ObjectArray::ObjectArray(ObjectArray&& other) noexcept :
+		type(std::move(other.type)), columns(std::move(other.columns)), count(other.count), capacity(other.capacity)
+	{
+		other.columns.clear();
+		other.count = 0;
+		other.capacity = 0;
+	}
+
+	const ObjectArray::_Column* ObjectArray::_find_column(const char* name) const {
+		auto found = this->columns.find(name);
+		if (found == this->columns.end()) {
+			return nullptr;
+		}
+		return &found->second;
+	}
+	void* ObjectArray::_column_address(const char* name, size_t size, size_t align) {
+		const _Column* column = this->_find_column(name);
+		if (column == nullptr || !column->field.unboxed || column->stride != size || column->field.align < align) {
+			return nullptr;
+		}
+		return column->data;
+	}
+	void* ObjectArray::_element_address(size_t index, const char* name, size_t size, size_t align) {
+		const _Column* column = this->_find_column(name);
+		if (column == nullptr || !column->field.unboxed || column->field.size != size || column->field.align < align) {
+			return nullptr;
+		}
+		return reinterpret_cast<byte*>(column->data) + index * column->stride;
+	}
+	Ref<Object> ObjectArray::_get_field(size_t index, const char* name) {
+		const _Column* column = this->_find_column(name);
+		if (column == nullptr) {
+			return nullptr;
+		}
+		void* where = reinterpret_cast<byte*>(column->data) + index * column->stride;
+		if (column->field.unboxed) {
+			return Object::inplace_load(column->field.type, where, column->field.size);
+		}
+		return *reinterpret_cast<Object**>(where);
+	}
+	bool ObjectArray::_set_field(size_t index, const char* name, Ref<Object> value) {
+		const _Column* column = this->_find_column(name);
+		if (column == nullptr) {
+			return false;
+		}
+		const FieldInfo& field = column->field;
+		if (value == nullptr) {
+			if (field.unboxed) {
+				return false;  // unboxed fields always hold a value.
+			}
+		}
+		else if (field.type != nullptr && !field.type->instance_check(value)) {
+			return false;
+		}
+
+		void* where = reinterpret_cast<byte*>(column->data) + index * column->stride;
+		if (field.unboxed) {
+			return field.type->inplace_store(where, field.size, value);
+		}
+		Object*& slot = *reinterpret_cast<Object**>(where);
+		Object* old = slot;
+		slot = value.get();
+		Object::_incRef(slot);
+		Object::_decRef(old);
+		return true;
+	}
+	// release the boxed fields of the elements in [begin, end), and unset their fields.
+	void ObjectArray::_release(size_t begin, size_t end) {
+		for (auto& [name, column] : this->columns) {
+			byte* data = reinterpret_cast<byte*>(column.data);
+			if (!column.field.unboxed) {
+				for (size_t i = begin; i < end; i++) {
+					Object*& slot = *reinterpret_cast<Object**>(data + i * column.stride);
+					Object::_decRef(slot);
+				}
+			}
+			std::memset(data + begin * column.stride, 0, (end - begin) * column.stride);
+		}
+	}
+
+	Ref<Type> ObjectArray::get_type() const {
+		return this->type;
+	}
+	size_t ObjectArray::size() const {
+		return this->count;
+	}
+	size_t ObjectArray::get_capacity() const {
+		return this->capacity;
+	}
+	void ObjectArray::reserve(size_t capacity) {
+		if (capacity <= this->capacity) {
+			return;
+		}
+		for (auto& [name, column] : this->columns) {
+			size_t align = std::max(column.field.align, _column_align);
+			byte* data = reinterpret_cast<byte*>(::operator new(capacity * column.stride, std::align_val_t(align)));
+			if (column.data) {
+				std::memcpy(data, column.data, this->count * column.stride);
+				::operator delete(column.data, std::align_val_t(align));
+			}
+			// unset fields read as nullptr, or as zeroes for unboxed ones.
+			std::memset(data + this->count * column.stride, 0, (capacity - this->count) * column.stride);
+			column.data = data;
+		}
+		this->capacity = capacity;
+	}
+	void ObjectArray::resize(size_t count) {
+		if (count < this->count) {
+			this->_release(count, this->count);
+		}
+		else if (count > this->capacity) {
+			this->reserve(std::max(count, this->capacity * 2));
+		}
+		this->count = count;
+	}
+	size_t ObjectArray::set_fields(const char* name, size_t first, Object* const* values, size_t count) {
+		const _Column* column = this->_find_column(name);
+		if (column == nullptr) {
+			return 0;
+		}
+		if (first > this->count || count > this->count - first) {
+			throw SiliconException("object array range out of bounds.");
+		}
+		const FieldInfo& field = column->field;
+		byte* where = reinterpret_cast<byte*>(column->data) + first * column->stride;
+		if (field.unboxed) {
+			return field.type->inplace_store_batch(where, column->stride, values, count);
+		}
+		for (size_t i = 0; i < count; i++, where += column->stride) {
+			Object* value = values[i];
+			if (value != nullptr && field.type != nullptr && !field.type->instance_check(value)) {
+				return i;
+			}
+			Object*& slot = *reinterpret_cast<Object**>(where);
+			Object* old = slot;
+			slot = value;
+			Object::_incRef(slot);
+			Object::_decRef(old);
+		}
+		return count;
+	}
+	bool ObjectArray::get_fields(const char* name, size_t first, Ref<Object>* values, size_t count) {
+		const _Column* column = this->_find_column(name);
+		if (column == nullptr) {
+			return false;
+		}
+		if (first > this->count || count > this->count - first) {
+			throw SiliconException("object array range out of bounds.");
+		}
+		byte* where = reinterpret_cast<byte*>(column->data) + first * column->stride;
+		if (!column->field.unboxed) {
+			for (size_t i = 0; i < count; i++, where += column->stride) {
+				values[i] = *reinterpret_cast<Object**>(where);
+			}
+			return true;
+		}
+		// decode by chunks, so that the codec is called once per chunk.
+		Object* decoded[64];
+		for (size_t done = 0; done < count; ) {
+			size_t chunk = std::min<size_t>(count - done, std::size(decoded));
+			column->field.type->inplace_load_batch(where + done * column->stride, column->stride, decoded, chunk);
+			for (size_t i = 0; i < chunk; i++) {
+				values[done + i] = decoded[i];
+			}
+			done += chunk;
+		}
+		return true;
+	}
+	ObjectArray::Element ObjectArray::at(size_t index) {
+		if (index >= this->count) {
+			throw SiliconException("object array index out of range.");
+		}
+		return Element(this, index);
+	}
+
+	ObjectArray::~ObjectArray() {
+		if (this->capacity == 0) {
+			return;
+		}
+		this->_release(0, this->count);
+		for (auto& [name, column] : this->columns) {
+			::operator delete(column.data, std::align_val_t(std::max(column.field.align, _column_align)));
+		}
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include "Ref.hpp"
+#include <string>
+
+
+namespace Silicon {
+
+	/*
+	Columnar storage for many instances of one type: each field of the
+	type is stored in its own contiguous column, instead of one memory
+	block per instance. Scanning a field over all the elements reads a
+	single array linearly, see column().
+	Elements only hold the fields of the type. They have no C data and
+	are not objects: they are accessed through Element proxies, which
+	offer the same field accessors as Object.
+	*/
+	class ObjectArray {
+		struct _Column {
+			FieldInfo field;
+			size_t stride;  // distance between the values of consecutive elements.
+			void* data;
+		};
+
+		Ref<Type> type;
+		namedict<_Column> columns;
+		size_t count;
+		size_t capacity;
+
+		const _Column* _find_column(const char* name) const;
+		void* _column_address(const char* name, size_t size, size_t align);
+		void* _element_address(size_t index, const char* name, size_t size, size_t align);
+		Ref<Object> _get_field(size_t index, const char* name);
+		bool _set_field(size_t index, const char* name, Ref<Object> value);
+		void _release(size_t begin, size_t end);
+
+	public:
+		/*
+		Proxy to an element of an array. It is only valid while the
+		element is in the array, and as long as the array is not grown.
+		*/
+		class Element {
+			ObjectArray* array;
+			size_t index;
+
+		public:
+			inline Element(ObjectArray* array, size_t index) :
+				array(array), index(index)
+			{}
+
+			inline size_t position() const {
+				return this->index;
+			}
+			// see Object::field().
+			template<class T>
+				requires std::is_trivially_copyable_v<T>
+			inline T* field(const char* name) {
+				return static_cast<T*>(this->array->_element_address(this->index, name, sizeof(T), alignof(T)));
+			}
+			// see Object::get_field().
+			inline Ref<Object> get_field(const char* name) {
+				return this->array->_get_field(this->index, name);
+			}
+			// see Object::set_field().
+			inline bool set_field(const char* name, Ref<Object> value) {
+				return this->array->_set_field(this->index, name, value);
+			}
+		};
+
+		// array of count elements whose fields are unset.
+		ObjectArray(Ref<Type> type, size_t count = 0);
+		ObjectArray(const ObjectArray&) = delete;
+		ObjectArray& operator =(const ObjectArray&) = delete;
+		ObjectArray(ObjectArray&& other) noexcept;
+
+		Ref<Type> get_type() const;
+		size_t size() const;
+		size_t get_capacity() const;
+		void reserve(size_t capacity);
+		/*
+		Change the number of elements. New elements have their fields
+		unset, as in new instances; removed elements release their fields.
+		*/
+		void resize(size_t count);
+
+		// no bounds check.
+		inline Element operator [](size_t index) {
+			return Element(this, index);
+		}
+		Element at(size_t index);
+
+		/*
+		The values of an unboxed field for all the elements, as a
+		contiguous array of size() values. Returns nullptr if the type has
+		no unboxed field of that name whose layout matches T.
+		The column moves when the array is grown.
+		*/
+		template<class T>
+			requires std::is_trivially_copyable_v<T>
+		inline T* column(const char* name) {
+			return static_cast<T*>(this->_column_address(name, sizeof(T), alignof(T)));
+		}
+		/*
+		Write a field of the count elements starting at first. Unboxed
+		columns are written in one call to the batch codec of the type of
+		the field, which rejects the values it cannot represent.
+		Returns the number of elements written, which stops at the first
+		value that was rejected.
+		*/
+		size_t set_fields(const char* name, size_t first, Object* const* values, size_t count);
+		/*
+		Read a field of the count elements starting at first. Returns false
+		if the type has no such field.
+		*/
+		bool get_fields(const char* name, size_t first, Ref<Object>* values, size_t count);
+
+		~ObjectArray();
+	};
+}
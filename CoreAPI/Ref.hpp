@@ -19,16 +19,12 @@ namespace Silicon {
 		inline Ref(T* src) :
 			target(src)
 		{
-			if (this->target) {
-				this->target->incRef();
-			}
+			Object::_incRef(this->target);
 		}
 		inline Ref(const Ref<T>& other) :
 			target(other.target)
 		{
-			if (this->target) {
-				this->target->incRef();
-			}
+			Object::_incRef(this->target);
 		}
 		inline Ref(Ref<T>&& other) noexcept :
 			target(other.target)
@@ -38,18 +34,12 @@ namespace Silicon {
 		inline Ref<T>& operator =(const Ref<T>& other) {
 			Object* old = this->target;
 			this->target = other.target;
-			if (this->target) {
-				this->target->incRef();
-			}
-			if (old) {
-				old->decRef();
-			}
+			Object::_incRef(this->target);
+			Object::_decRef(old);
 			return *this;
 		}
 		inline Ref<T>& operator =(Ref<T>&& other) noexcept {
-			if (this->target) {
-				this->target->decRef();
-			}
+			Object::_decRef(this->target);
 			this->target = other.target;
 			other.target = nullptr;
 			return *this;
@@ -64,33 +54,44 @@ namespace Silicon {
 		inline const T* operator->() const {
 			return static_cast<T*>(this->target);
 		}
+		// return the target as a borrowed pointer, without taking a new reference.
+		inline T* get() const {
+			return static_cast<T*>(this->target);
+		}
 		inline explicit operator bool() const {
 			return this->target != nullptr;
 		}
 		template<class TBase>
 			requires std::is_base_of_v<TBase, T>
-		inline operator Ref<TBase>() {
+		inline operator Ref<TBase>() const {
 			return Ref<TBase>(this->target);
 		}
+		// immediates are not instances of any C++ subclass of Object.
 		template<class TChild>
 			requires std::is_base_of_v<T, TChild>
 		inline Ref<TChild> DownCast() {
+			if (Immediate::is_immediate(this->target)) {
+				return nullptr;
+			}
 			return Ref<TChild>(dynamic_cast<TChild*>(this->target));
 		}
 		template<class TChild>
 			requires std::is_base_of_v<T, TChild>
 		inline const Ref<TChild> DownCast() const {
+			if (Immediate::is_immediate(this->target)) {
+				return nullptr;
+			}
 			return Ref<TChild>(dynamic_cast<TChild*>(this->target));
 		}
 		bool is(Ref<Object> other) const {
 			return this->target == other.target;
 		}
 		inline ~Ref() {
-			if (this->target) {
-				this->target->decRef();
-				this->target = nullptr;
-			}
+			Object::_decRef(this->target);
+			this->target = nullptr;
 		}
 	};
 }
 
+// defined after Ref, which it holds by value.
+#include "CallResult.hpp"
@@ -0,0 +1,40 @@
+#include "Shape.hpp"
+
+
+namespace Silicon {
+
+	Shape::Shape() :
+		parent(nullptr), name(), count(0), transition_lock(), transitions()
+	{}
+	Shape::Shape(const Shape* parent, const std::string& name) :
+		parent(parent), name(name), count(parent->count + 1), transition_lock(), transitions()
+	{}
+	size_t Shape::size() const {
+		return this->count;
+	}
+	const Shape* Shape::get_parent() const {
+		return this->parent;
+	}
+	bool Shape::find(const char* name, size_t* index) const {
+		for (const Shape* shape = this; shape->parent != nullptr; shape = shape->parent) {
+			if (shape->name == name) {
+				*index = shape->count - 1;
+				return true;
+			}
+		}
+		return false;
+	}
+	const Shape* Shape::with(const char* name) const {
+		std::lock_guard<std::mutex> guard(this->transition_lock);
+		auto [where, inserted] = this->transitions.try_emplace(name, nullptr);
+		if (inserted) {
+			where->second = new Shape(this, where->first);
+		}
+		return where->second;
+	}
+	Shape::~Shape() {
+		for (auto& [name, child] : this->transitions) {
+			delete child;
+		}
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "Ref.hpp"
+#include <mutex>
+#include <string>
+
+
+namespace Silicon {
+
+	/*
+	Hidden class of instances with dynamic attributes: which attributes
+	an instance holds, and the index at which each is stored.
+	Shapes are shared by all the instances that were given the same
+	attributes in the same order. They form a tree rooted at the empty
+	shape of a type: adding an attribute moves an instance to a child of
+	its shape, which is created upon the first such transition and reused
+	by all the following ones.
+	Shapes never change once created, and are owned by their type.
+	Each shape only holds the attribute it adds to its parent, so finding
+	an attribute walks up the tree: call sites should cache the index
+	found for each shape they see (see AttributeCache).
+	*/
+	class Shape {
+		const Shape* parent;
+		std::string name;  // of the last attribute, stored at index count - 1.
+		size_t count;
+
+		mutable std::mutex transition_lock;
+		mutable namedict<Shape*> transitions;
+
+		Shape(const Shape* parent, const std::string& name);
+
+	public:
+		// empty shape, root of a tree.
+		Shape();
+		Shape(const Shape&) = delete;
+		Shape& operator =(const Shape&) = delete;
+
+		// number of attributes.
+		size_t size() const;
+		const Shape* get_parent() const;
+		bool find(const char* name, OUT size_t* index) const;
+		/*
+		Shape with one more attribute, stored at index size().
+		Thread-safe.
+		*/
+		const Shape* with(const char* name) const;
+
+		~Shape();
+	};
+}
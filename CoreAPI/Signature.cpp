@@ -0,0 +1,63 @@
+#include "Signature.hpp"
+
+
+namespace Silicon {
+	args_t Signature::_names(const std::vector<Param>& params) {
+		args_t names;
+		names.reserve(params.size());
+		for (auto& param : params) {
+			names.push_back(param.name);
+		}
+		return names;
+	}
+	Signature::Signature(std::vector<Param> params) :
+		params(params), kwds(_names(params))
+	{}
+	size_t Signature::size() const {
+		return this->params.size();
+	}
+	const CallError* Signature::bind(ArgVector args, Object** out) const {
+		if (args.size() > this->params.size()) {
+			return &CallError::wrong_arity;
+		}
+		if (!this->kwds.match(args, out)) {
+			return &CallError::unexpected_keyword;
+		}
+		for (size_t i = 0; i < args.size(); i++) {
+			if (out[i] != nullptr) {
+				return &CallError::unexpected_keyword;  // also passed as a keyword.
+			}
+			out[i] = args[i];
+		}
+		for (size_t i = 0; i < this->params.size(); i++) {
+			const Param& param = this->params[i];
+			Object* arg = out[i];
+			if (arg == nullptr) {
+				if (!param.optional) {
+					return &CallError::wrong_arity;
+				}
+				continue;
+			}
+			Type* type = param.type.get();
+			if (type == nullptr || type_of(arg) == type) {
+				continue;
+			}
+			if (!type->instance_check(arg)) {
+				return &CallError::wrong_type;
+			}
+		}
+		return nullptr;
+	}
+	const CallError* Signature::check(ArgVector args) const {
+		constexpr size_t inline_capacity = 8;
+		Object* inline_bound[inline_capacity];
+		std::vector<Object*> heap_bound;
+
+		Object** bound = inline_bound;
+		if (this->params.size() > inline_capacity) {
+			heap_bound.resize(this->params.size());
+			bound = heap_bound.data();
+		}
+		return this->bind(args, bound);
+	}
+}
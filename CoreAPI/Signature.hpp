@@ -0,0 +1,52 @@
+#pragma once
+#include "Ref.hpp"
+#include <vector>
+
+
+namespace Silicon {
+
+	/*
+	Parameters of a callable: their types, whether they can be omitted
+	and the names they can be passed by as keywords. A signature is
+	built once per callable, and validates the arguments of each call
+	in a single pass.
+	*/
+	class Signature {
+	public:
+		struct Param {
+			Ref<Type> type;  // nullptr accepts any object.
+			bool optional = false;
+			Ref<Object> name = nullptr;  // nullptr if the parameter cannot be passed as a keyword.
+		};
+
+	private:
+		std::vector<Param> params;
+		KwdMatcher kwds;
+
+		static args_t _names(const std::vector<Param>& params);
+
+	public:
+		Signature(std::vector<Param> params);
+		Signature(const Signature&) = delete;
+		Signature& operator =(const Signature&) = delete;
+
+		size_t size() const;
+		/*
+		Match the arguments of a call against the parameters, and store
+		into out[i] the argument passed for the i-th parameter, or nullptr
+		if it was omitted. out must hold size() entries.
+		Returns nullptr if the arguments match the signature, or the error
+		to report from the call otherwise:
+		 - wrong_arity if there are more positional arguments than
+		   parameters, or if a parameter that is not optional is omitted;
+		 - unexpected_keyword if a keyword names no parameter, or one that
+		   was also passed positionally;
+		 - wrong_type if an argument is not an instance of the type of its
+		   parameter.
+		Arguments whose type is exactly the type of their parameter are
+		accepted with a single pointer comparison.
+		*/
+		const CallError* bind(ArgVector args, OUT Object** out) const;
+		const CallError* check(ArgVector args) const;
+	};
+}
@@ -1,3 +1,199 @@
+/*
+Helpers to define types from ordinary C++ code.
+*/
+#pragma once
+#include "Ref.hpp"
+#include <tuple>
+#include <utility>
+#include <functional>
 
 
+namespace Silicon {
 
+	namespace _Helpers {
+
+		// check that a native argument is an instance of T.
+		template<complete_obj_class T>
+		inline bool _check_instance(Object* arg) {
+			if (arg == nullptr) {
+				return false;
+			}
+			if constexpr (std::same_as<T, Object>) {
+				return true;  // every object is an instance of Object.
+			}
+			else {
+				return typeof<T>->instance_check(arg);
+			}
+		}
+
+		/*
+		Conversion of native arguments to the parameter types of bound
+		functions. Only specializations are defined, one for each
+		supported parameter type.
+		*/
+		template<class P>
+		struct _param;
+
+		template<complete_obj_class T>
+		struct _param<Ref<T>> {
+			static inline bool check(Object* arg) {
+				return _check_instance<T>(arg);
+			}
+			static inline Ref<T> unbox(Object* arg) {
+				return Ref<T>(static_cast<T*>(arg));
+			}
+		};
+		template<complete_obj_class T>
+		struct _param<T*> {
+			static inline bool check(Object* arg) {
+				return _check_instance<T>(arg);
+			}
+			static inline T* unbox(Object* arg) {
+				return static_cast<T*>(arg);
+			}
+		};
+		// immediates, passed without any allocation.
+		template<>
+		struct _param<intptr_t> {
+			static inline bool check(Object* arg) {
+				return Immediate::is_int(arg);
+			}
+			static inline intptr_t unbox(Object* arg) {
+				return Immediate::to_int(arg);
+			}
+		};
+		template<>
+		struct _param<bool> {
+			static inline bool check(Object* arg) {
+				return Immediate::is_bool(arg);
+			}
+			static inline bool unbox(Object* arg) {
+				return arg == Immediate::true_value();
+			}
+		};
+
+		template<object_class T>
+		inline Ref<Object> _box(Ref<T> result) {
+			return result;
+		}
+		template<object_class T>
+		inline Ref<Object> _box(T* result) {
+			return Ref<Object>(result);
+		}
+		inline Ref<Object> _box(intptr_t result) {
+			if (!Immediate::fits_int(result)) {
+				throw SiliconException("integer result out of the range of immediates.");
+			}
+			return Ref<Object>(Immediate::from_int(result));
+		}
+		inline Ref<Object> _box(bool result) {
+			return Ref<Object>(Immediate::from_bool(result));
+		}
+
+		// parameter and return types of functions and member functions.
+		template<class F>
+		struct _signature;
+
+		template<class R, class ...A>
+		struct _signature<R(*)(A...)> {
+			using self_type = void;
+			using return_type = R;
+			using params = std::tuple<std::remove_cvref_t<A>...>;
+		};
+		template<class R, class C, class ...A>
+		struct _signature<R(C::*)(A...)> {
+			using self_type = C;
+			using return_type = R;
+			using params = std::tuple<std::remove_cvref_t<A>...>;
+		};
+		template<class R, class C, class ...A>
+		struct _signature<R(C::*)(A...) const> {
+			using self_type = C;
+			using return_type = R;
+			using params = std::tuple<std::remove_cvref_t<A>...>;
+		};
+	}
+
+	/*
+	Binding of the C++ function or member function Func as a native method.
+	Parameters must be of type Ref<T> or T*, where T is a class with a
+	type object, or intptr_t or bool, which accept the corresponding
+	immediates (see Immediate). The return type is void, or any of these.
+	For member functions, the instance is passed as the first argument.
+
+	The arity check, the type checks and the conversions of arguments are
+	generated at compile time. Types bound with bindCppType<T>() must bind
+	the C++ classes of their bases as bases of T, so that arguments can be
+	converted with static_cast once they pass their type check.
+	*/
+	template<auto Func>
+	class NativeMethod {
+		using signature = _Helpers::_signature<decltype(Func)>;
+		using self_type = typename signature::self_type;
+		using return_type = typename signature::return_type;
+		using params = typename signature::params;
+
+		static constexpr bool is_member = !std::is_void_v<self_type>;
+		static constexpr size_t first_param = is_member ? 1 : 0;
+
+		template<size_t ...I>
+		static inline bool _check(ArgVector args, std::index_sequence<I...>) {
+			if constexpr (is_member) {
+				if (!_Helpers::_check_instance<self_type>(args[0])) {
+					return false;
+				}
+			}
+			return (... && _Helpers::_param<std::tuple_element_t<I, params>>::check(args[first_param + I]));
+		}
+		template<size_t ...I>
+		static inline return_type _invoke(ArgVector args, std::index_sequence<I...>) {
+			if constexpr (is_member) {
+				return std::invoke(Func, static_cast<self_type*>(args[0]),
+					_Helpers::_param<std::tuple_element_t<I, params>>::unbox(args[first_param + I])...);
+			}
+			else {
+				return std::invoke(Func, _Helpers::_param<std::tuple_element_t<I, params>>::unbox(args[first_param + I])...);
+			}
+		}
+
+	public:
+		// number of positional arguments expected, including the instance for member functions.
+		static constexpr size_t arity = std::tuple_size_v<params> + first_param;
+
+		/*
+		Checked entry point, following the vectorfunc calling convention.
+		Returns CallError::wrong_arity or CallError::wrong_type if the
+		arguments do not match the parameters of Func.
+		*/
+		static CallResult call(ArgVector args) {
+			if (args.size() != arity || args.kwd_names().size() != 0) {
+				return CallError::wrong_arity;
+			}
+			auto indices = std::make_index_sequence<std::tuple_size_v<params>>();
+			if (!_check(args, indices)) {
+				return CallError::wrong_type;
+			}
+			if constexpr (std::is_void_v<return_type>) {
+				_invoke(args, indices);
+				return nullptr;
+			}
+			else {
+				return _Helpers::_box(_invoke(args, indices));
+			}
+		}
+
+		// the checked entry point, as a callable stored without allocation.
+		static inline CallableHelper::vectorfunc callable() {
+			return &call;
+		}
+
+		/*
+		Direct entry point for callers that already know the types of the
+		arguments: calls Func without any check or conversion.
+		*/
+		template<class ...TArgs>
+		static inline return_type invoke(TArgs&&... args) {
+			return std::invoke(Func, std::forward<TArgs>(args)...);
+		}
+	};
+}
@@ -1,5 +1,7 @@
 #include "Allocator.hpp"
 #include <memory>
+#include <cstdint>
+#include <cstring>
 
 
 namespace Silicon {
@@ -13,5 +15,21 @@ namespace Silicon {
 		this->free(src);
 		return newmem;
 	}
+	void* Allocator::allocate_aligned(size_t size, size_t align) {
+		void* block = this->allocate(size + align - 1 + sizeof(void*));
+		if (block == nullptr) {
+			return nullptr;
+		}
+		uintptr_t start = reinterpret_cast<uintptr_t>(block) + sizeof(void*);
+		void* aligned = reinterpret_cast<void*>((start + align - 1) & ~(uintptr_t)(align - 1));
+		reinterpret_cast<void**>(aligned)[-1] = block;
+		return aligned;
+	}
+	void Allocator::free_aligned(void* ptr, size_t align) {
+		if (ptr == nullptr) {
+			return;
+		}
+		this->free(reinterpret_cast<void**>(ptr)[-1]);
+	}
 }
 
@@ -7,6 +7,14 @@ namespace Silicon {
 		virtual void* allocate(size_t) = 0;
 		virtual void free(void*) = 0;
 		virtual void* reallocate(void*, size_t, size_t);
+		/*
+		Allocate a block aligned on align, a power of two, and free it.
+		The default implementation over-allocates with allocate() and keeps
+		the address of the actual block right before the aligned one.
+		Backends that can align natively should override both.
+		*/
+		virtual void* allocate_aligned(size_t size, size_t align);
+		virtual void free_aligned(void* ptr, size_t align);
 	};
 }
 
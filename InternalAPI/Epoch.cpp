@@ -0,0 +1,110 @@
+#include "Epoch.hpp"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+
+namespace Silicon {
+
+	namespace InternalAPI {
+
+		/*
+		Per-thread pinning state. Records are never freed: when a thread
+		exits, its record is released and reused by the next thread that
+		pins for the first time.
+		*/
+		struct ThreadRecord {
+			std::atomic<uint64_t> epoch = 0;  // 0 when the thread is not pinned.
+			std::atomic<bool> in_use = true;
+			uint32_t nesting = 0;
+			ThreadRecord* next = nullptr;
+		};
+
+		struct RetiredMemory {
+			void* ptr;
+			void (*deleter)(void*);
+			uint64_t epoch;
+		};
+
+		std::atomic<uint64_t> global_epoch = 1;
+		std::atomic<ThreadRecord*> thread_records = nullptr;
+
+		std::mutex retired_lock;
+		std::vector<RetiredMemory> retired;
+
+
+		ThreadRecord* acquire_record() {
+			for (ThreadRecord* rec = thread_records.load(); rec; rec = rec->next) {
+				bool expected = false;
+				if (rec->in_use.compare_exchange_strong(expected, true)) {
+					return rec;
+				}
+			}
+			ThreadRecord* rec = new ThreadRecord();
+			rec->next = thread_records.load();
+			while (!thread_records.compare_exchange_weak(rec->next, rec)) {}
+			return rec;
+		}
+
+		struct ThreadRecordOwner {
+			ThreadRecord* record = acquire_record();
+
+			inline ~ThreadRecordOwner() {
+				this->record->epoch.store(0);
+				this->record->nesting = 0;
+				this->record->in_use.store(false);
+			}
+		};
+
+		ThreadRecord* current_record() {
+			thread_local ThreadRecordOwner owner;
+			return owner.record;
+		}
+
+
+		EpochGuard::EpochGuard() {
+			ThreadRecord* rec = current_record();
+			if (rec->nesting++ == 0) {
+				rec->epoch.store(global_epoch.load());
+			}
+		}
+		EpochGuard::~EpochGuard() {
+			ThreadRecord* rec = current_record();
+			if (--rec->nesting == 0) {
+				rec->epoch.store(0);
+			}
+		}
+
+		void retire(void* ptr, void (*deleter)(void*)) {
+			{
+				std::lock_guard<std::mutex> lock(retired_lock);
+				// readers that pin from now on can no longer observe ptr.
+				retired.push_back({ ptr, deleter, global_epoch.fetch_add(1) });
+			}
+			collect();
+		}
+
+		void collect() {
+			std::lock_guard<std::mutex> lock(retired_lock);
+
+			uint64_t oldest_pinned = UINT64_MAX;
+			for (ThreadRecord* rec = thread_records.load(); rec; rec = rec->next) {
+				uint64_t epoch = rec->epoch.load();
+				if (epoch != 0 && epoch < oldest_pinned) {
+					oldest_pinned = epoch;
+				}
+			}
+
+			size_t kept = 0;
+			for (RetiredMemory& mem : retired) {
+				if (mem.epoch < oldest_pinned) {
+					mem.deleter(mem.ptr);
+				}
+				else {
+					retired[kept++] = mem;
+				}
+			}
+			retired.resize(kept);
+		}
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+
+
+namespace Silicon {
+
+	namespace InternalAPI {
+
+		/*
+		Pins the calling thread to the current epoch for as long as it lives.
+		Memory retired while a thread is pinned is not reclaimed before that
+		thread unpins, so data read from shared structures stays valid
+		within the guard's scope.
+		Guards can be nested. Pinning and unpinning never block.
+		*/
+		class EpochGuard {
+		public:
+			EpochGuard();
+			EpochGuard(const EpochGuard&) = delete;
+			EpochGuard& operator =(const EpochGuard&) = delete;
+			~EpochGuard();
+		};
+
+		/*
+		Schedule memory for deletion once no pinned thread can still
+		observe it. deleter is called with ptr at that point.
+		*/
+		void retire(void* ptr, void (*deleter)(void*));
+
+		/*
+		Reclaim retired memory that is no longer observable by any
+		pinned thread. Called by retire(), but can be called at any time.
+		*/
+		void collect();
+	}
+}
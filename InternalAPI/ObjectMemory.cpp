@@ -1,4 +1,7 @@
 #include "ObjectMemory.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
 
 
 namespace Silicon {
@@ -12,13 +15,18 @@ namespace Silicon {
 			void (*free_cb)(void*) = nullptr;
 			void* param;
 		};
+		static_assert(sizeof(ObjectHead) == MemoryLayout::head_size, "MemoryLayout::head_size does not match the object header.");
 
 
 		OPAQUE_DEF(ObjectMemory) {
 			ObjectHead* head;
 		};
 		size_t MemoryLayout::totalsize() const {
-			return sizeof(ObjectHead) + this->c_size + this->c_pad + (this->fieldcount * sizeof(void*));
+			size_t size = sizeof(ObjectHead) + this->c_size + this->c_pad + this->fields_size;
+			if (this->instance_align != 0) {
+				size = inthandling::align_up(size, this->instance_align);
+			}
+			return size;
 		}
 		void* MemoryLayout::c_most_derived(void* _head) const {
 			byte* head = reinterpret_cast<byte*>(_head);
@@ -32,9 +40,19 @@ namespace Silicon {
 			byte* head = reinterpret_cast<byte*>(_head);
 			return head + sizeof(ObjectHead) + this->c_size + this->c_pad;
 		}
-		MemoryLayout::MemoryLayout(size_t c_size, uint16_t fieldcount, size_t c_align, size_t c_root_offset) :
-			c_size(c_size), c_root_offset(c_root_offset), fieldcount(fieldcount), c_pad(c_align - (c_size % c_align))
-		{}
+		void* MemoryLayout::cold_fields(void* head) const {
+			if (this->cold_size == 0) {
+				return nullptr;
+			}
+			return *reinterpret_cast<void**>(reinterpret_cast<byte*>(this->fields(head)) + this->cold_slot);
+		}
+		MemoryLayout::MemoryLayout(size_t c_size, size_t c_align, size_t fields_size, size_t fields_align, size_t c_root_offset) :
+			c_size(c_size), c_root_offset(c_root_offset), fields_size(fields_size), fields_align(fields_align)
+		{
+			// the field area starts right after the pad, and must be aligned for the fields as well.
+			size_t align = std::max<size_t>({ c_align, fields_align, 1 });
+			this->c_pad = inthandling::align_up(c_size, align) - c_size;
+		}
 
 
 		ObjectMemory::ObjectMemory(ObjectHead* head) {
@@ -61,20 +79,34 @@ namespace Silicon {
 		}
 		ObjectMemory ObjectMemory::allocate(const MemoryLayout* layout, void* where, Allocator* allocator) {
 			size_t totalsize = layout->totalsize();
+			size_t align = layout->instance_align;
 
 			byte* result;
 			AllocationMethod allocmethod;
 
 			if (where != nullptr) {
+				if (align != 0 && reinterpret_cast<uintptr_t>(where) % align != 0) {
+					throw bad_alignment();
+				}
 				result = reinterpret_cast<byte*>(where);
 				allocmethod = AllocationMethod::EXTERNAL;
 			}
 			else if (allocator != nullptr) {
-				result = reinterpret_cast<byte*>(allocator->allocate(totalsize));
+				if (align != 0) {
+					result = reinterpret_cast<byte*>(allocator->allocate_aligned(totalsize, align));
+				}
+				else {
+					result = reinterpret_cast<byte*>(allocator->allocate(totalsize));
+				}
 				allocmethod = AllocationMethod::ALLOCATOR;
 			}
 			else {
-				result = new byte[totalsize];
+				if (align != 0) {
+					result = reinterpret_cast<byte*>(::operator new(totalsize, std::align_val_t(align)));
+				}
+				else {
+					result = new byte[totalsize];
+				}
 				allocmethod = AllocationMethod::NEW;
 			}
 
@@ -87,6 +119,24 @@ namespace Silicon {
 			head->allocmethod = allocmethod;
 			head->layout = const_cast<MemoryLayout*>(layout);
 
+			// unset fields read as nullptr, or as zeroes for unboxed ones.
+			std::memset(layout->fields(head), 0, layout->fields_size);
+			if (layout->cold_size != 0) {
+				// the cold block comes from the same allocator as the instance.
+				void* cold;
+				if (head->allocator != nullptr) {
+					cold = head->allocator->allocate_aligned(layout->cold_size, layout->cold_align);
+					if (cold == nullptr) {
+						throw std::bad_alloc();
+					}
+				}
+				else {
+					cold = ::operator new(layout->cold_size, std::align_val_t(layout->cold_align));
+				}
+				std::memset(cold, 0, layout->cold_size);
+				*reinterpret_cast<void**>(reinterpret_cast<byte*>(layout->fields(head)) + layout->cold_slot) = cold;
+			}
+
 			return ObjectMemory(head);
 		}
 		ObjectMemory ObjectMemory::from_most_derived(void* mostderived) {
@@ -118,6 +168,15 @@ namespace Silicon {
 			if (this->impl->head->free_cb) {
 				this->impl->head->free_cb(this->impl->head->param);
 			}
+			MemoryLayout* layout = this->impl->head->layout;
+			if (void* cold = layout->cold_fields(this->impl->head)) {
+				if (this->impl->head->allocator != nullptr) {
+					this->impl->head->allocator->free_aligned(cold, layout->cold_align);
+				}
+				else {
+					::operator delete(cold, std::align_val_t(layout->cold_align));
+				}
+			}
 
 			byte* to_del;
 			switch (this->impl->head->allocmethod) {
@@ -125,6 +184,10 @@ namespace Silicon {
 				break;
 
 			case AllocationMethod::NEW:
+				if (layout->instance_align != 0) {
+					::operator delete(this->impl->head, std::align_val_t(layout->instance_align));
+					break;
+				}
 				to_del = reinterpret_cast<byte*>(this->impl->head);
 				delete[] to_del;
 				break;
@@ -133,6 +196,10 @@ namespace Silicon {
 				if (this->impl->head->allocator == nullptr) {
 					throw bad_allocator();
 				}
+				if (layout->instance_align != 0) {
+					this->impl->head->allocator->free_aligned(this->impl->head, layout->instance_align);
+					break;
+				}
 				this->impl->head->allocator->free(this->impl->head);
 				break;
 
@@ -27,6 +27,11 @@ namespace Silicon {
 			inline bad_allocator() : exception("bad allocator.") {}
 		};
 
+		class bad_alignment : std::exception {
+		public:
+			inline bad_alignment() : exception("memory is not aligned as required by the layout.") {}
+		};
+
 		enum class AllocationMethod : uint8_t {
 			NONE,
 			EXTERNAL,
@@ -35,21 +40,43 @@ namespace Silicon {
 		};
 
 		struct MemoryLayout {
+			// size of the header that precedes every object in memory.
+			static constexpr size_t head_size = 5 * sizeof(void*);
+
 			size_t c_size;
 			size_t c_root_offset;
 			size_t c_pad;
-			uint16_t fieldcount;
+			// size and alignment of the field area, which follows the C data.
+			size_t fields_size;
+			size_t fields_align;
+			/*
+			Size and alignment of the cold block of instances, allocated
+			separately for rarely accessed fields, and offset in the field
+			area of the pointer to it. No block is allocated if cold_size is 0.
+			*/
+			size_t cold_size = 0;
+			size_t cold_align = alignof(void*);
+			size_t cold_slot = 0;
+			/*
+			Alignment of whole instances, such as the size of a cache line,
+			or 0 for the default one. Instances then start on a boundary of
+			this alignment and their size is rounded up to a multiple of it,
+			so that no other allocation shares memory with them within that
+			granularity.
+			*/
+			size_t instance_align = 0;
 
 			size_t totalsize() const;
 			void* c_most_derived(void*) const;
 			void* c_root(void*) const;
 			void* fields(void*) const;
+			void* cold_fields(void*) const;
 
-			MemoryLayout(size_t c_size, uint16_t fieldcount, size_t c_align, size_t c_root_offset = inthandling::int_max<size_t>);
+			MemoryLayout(size_t c_size, size_t c_align, size_t fields_size = 0, size_t fields_align = alignof(void*), size_t c_root_offset = inthandling::int_max<size_t>);
 
 			template<class T>
-			static consteval size_t totalsizeof(const size_t fieldCount) {
-				return 24 + sizeof(T) + (alignof(T) - (sizeof(T) % alignof(T))) + (fieldCount * sizeof(void*));
+			static consteval size_t totalsizeof(const size_t fields_size) {
+				return head_size + inthandling::align_up(sizeof(T), alignof(T)) + fields_size;
 			}
 		};
 
@@ -0,0 +1,177 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace Silicon {
+
+	namespace InternalAPI {
+
+		// set while the thread runs ranges of a loop, so that nested loops run inline.
+		thread_local bool in_parallel_loop = false;
+
+		/*
+		One parallel loop. Ranges are claimed by advancing 'next'.
+		*/
+		struct _Loop {
+			size_t count;
+			size_t min_chunk;
+			size_t threads;
+			const std::function<void(size_t, size_t)>* body;
+
+			std::atomic<size_t> next = 0;
+			std::mutex error_lock;
+			std::exception_ptr error = nullptr;
+			size_t active = 0;  // workers running ranges of the loop, guarded by the lock of the pool.
+
+			inline bool exhausted() const {
+				return this->next.load(std::memory_order_relaxed) >= this->count;
+			}
+
+			inline bool claim(size_t* begin, size_t* end) {
+				size_t start = this->next.load(std::memory_order_relaxed);
+				while (start < this->count) {
+					size_t remaining = this->count - start;
+					size_t chunk = std::max(this->min_chunk, remaining / (2 * this->threads));
+					size_t stop = start + std::min(chunk, remaining);
+					if (this->next.compare_exchange_weak(start, stop, std::memory_order_relaxed)) {
+						*begin = start;
+						*end = stop;
+						return true;
+					}
+				}
+				return false;
+			}
+			void run() {
+				in_parallel_loop = true;
+				size_t begin, end;
+				while (this->claim(&begin, &end)) {
+					try {
+						(*this->body)(begin, end);
+					}
+					catch (...) {
+						std::lock_guard<std::mutex> guard(this->error_lock);
+						if (!this->error) {
+							this->error = std::current_exception();
+						}
+					}
+				}
+				in_parallel_loop = false;
+			}
+		};
+
+		struct ThreadPool::_State {
+			std::vector<std::thread> threads;
+
+			std::mutex lock;
+			std::condition_variable wake;
+			std::condition_variable done;
+			std::vector<_Loop*> loops;  // running loops, in the order they were started.
+			bool stopping = false;
+
+			// loop with iterations left and the fewest workers, or nullptr. Requires the lock.
+			_Loop* pick() const {
+				_Loop* picked = nullptr;
+				for (_Loop* loop : this->loops) {
+					if (!loop->exhausted() && (picked == nullptr || loop->active < picked->active)) {
+						picked = loop;
+					}
+				}
+				return picked;
+			}
+			void work() {
+				std::unique_lock<std::mutex> guard(this->lock);
+				while (true) {
+					_Loop* loop = nullptr;
+					this->wake.wait(guard, [&] {
+						return this->stopping || (loop = this->pick()) != nullptr;
+					});
+					if (this->stopping) {
+						return;
+					}
+					loop->active++;
+					guard.unlock();
+
+					loop->run();
+
+					guard.lock();
+					if (--loop->active == 0) {
+						this->done.notify_all();
+					}
+				}
+			}
+		};
+
+		ThreadPool::ThreadPool(size_t workers) :
+			state(new _State())
+		{
+			for (size_t i = 0; i < workers; i++) {
+				this->state->threads.emplace_back([state = this->state] {
+					state->work();
+				});
+			}
+		}
+		ThreadPool& ThreadPool::shared() {
+			static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+			return pool;
+		}
+		size_t ThreadPool::workers() const {
+			return this->state->threads.size();
+		}
+		void ThreadPool::parallel_for(size_t count, const std::function<void(size_t, size_t)>& body, size_t min_chunk) {
+			if (count == 0) {
+				return;
+			}
+			if (in_parallel_loop) {
+				body(0, count);
+				return;
+			}
+			if (this->workers() == 0 || count <= min_chunk) {
+				body(0, count);
+				return;
+			}
+
+			_Loop loop;
+			loop.count = count;
+			loop.min_chunk = std::max<size_t>(min_chunk, 1);
+			loop.threads = this->workers() + 1;
+			loop.body = &body;
+			{
+				std::lock_guard<std::mutex> guard(this->state->lock);
+				this->state->loops.push_back(&loop);
+			}
+			this->state->wake.notify_all();
+
+			loop.run();
+
+			{
+				// workers that have not joined yet must not see the loop once it returns.
+				std::unique_lock<std::mutex> guard(this->state->lock);
+				auto& loops = this->state->loops;
+				loops.erase(std::find(loops.begin(), loops.end(), &loop));
+				this->state->done.wait(guard, [&] {
+					return loop.active == 0;
+				});
+			}
+			if (loop.error) {
+				std::rethrow_exception(loop.error);
+			}
+		}
+		ThreadPool::~ThreadPool() {
+			{
+				std::lock_guard<std::mutex> guard(this->state->lock);
+				this->state->stopping = true;
+			}
+			this->state->wake.notify_all();
+			for (auto& thread : this->state->threads) {
+				thread.join();
+			}
+			delete this->state;
+		}
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+
+namespace Silicon {
+
+	namespace InternalAPI {
+
+		/*
+		Fixed set of worker threads running parallel loops. The thread
+		that starts a loop takes part in it, so a pool of n workers runs
+		loops on n + 1 threads.
+		*/
+		class ThreadPool {
+			struct _State;
+
+			_State* state;
+
+		public:
+			ThreadPool(size_t workers);
+			ThreadPool(const ThreadPool&) = delete;
+			ThreadPool& operator =(const ThreadPool&) = delete;
+
+			// pool shared by the runtime, with one worker less than the number of hardware threads.
+			static ThreadPool& shared();
+
+			size_t workers() const;
+			/*
+			Call body(begin, end) on disjoint ranges covering [0, count),
+			and return once all of them have returned. Ranges are handed
+			out in decreasing sizes, from a share of the remaining
+			iterations down to min_chunk, so that threads finishing early
+			pick up the rest of the work.
+			Loops started concurrently by different threads share the
+			workers, each idle worker joining the loop that has the fewest
+			workers. A loop started from within a loop is run entirely on
+			the calling thread. The first exception thrown by body is
+			rethrown once all the ranges have been run.
+			*/
+			void parallel_for(size_t count, const std::function<void(size_t begin, size_t end)>& body, size_t min_chunk = 1);
+
+			~ThreadPool();
+		};
+	}
+}
@@ -1,6 +1,13 @@
 #include <iostream>
 #include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
 #include "Ref.hpp"
+#include "Executor.hpp"
 
 
 struct S {
@@ -13,6 +20,85 @@ struct T {
 	int field2;
 };
 
+/*
+Time CallableHelper::typeCheckArgs() on argument lists of 1 to 8
+arguments, all checked against Object.
+*/
+void bench_typecheck_args(size_t iterations) {
+	using namespace Silicon;
+
+	for (size_t argc = 1; argc <= 8; argc++) {
+		args_t args(argc, Ref<Object>(Object::typeObject));
+		argtypes_t types(argc, Ref<Type>(Object::typeObject));
+		Ref<Object> exc;
+		size_t passed = 0;
+
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < iterations; i++) {
+			passed += CallableHelper::typeCheckArgs(args, types, &exc);
+		}
+		std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+		std::cout << "typeCheckArgs, " << argc << " args: " << elapsed.count() / iterations << " ns/call (" << passed << " passed)\n";
+	}
+}
+
+/*
+Time a tree of tasks of irregular cost on executors of 1 to N workers.
+Each root task spawns its children onto its own deque and joins them.
+*/
+void bench_executor_scaling(size_t roots, size_t children) {
+	using namespace Silicon;
+
+	static std::atomic<uint64_t> sink = 0;
+
+	CallableHelper leaf = CallableHelper::vectorfunc([](ArgVector) -> CallResult {
+		thread_local std::minstd_rand rng;
+		uint64_t iterations = 1000 + rng() % 50000;
+		uint64_t acc = 0;
+		for (uint64_t i = 0; i < iterations; i++) {
+			acc = acc * 6364136223846793005ull + i;
+		}
+		sink += acc;
+		return nullptr;
+	});
+	leaf.set_thread_safe();
+
+	CallableHelper* leaf_ptr = &leaf;
+	CallableHelper root = CallableHelper::vectorfunc([leaf_ptr, children](ArgVector) -> CallResult {
+		Executor* executor = Executor::current();
+		std::vector<std::future<Ref<Object>>> results;
+		for (size_t i = 0; i < children; i++) {
+			results.push_back(executor->submit(*leaf_ptr, {}));
+		}
+		for (auto& result : results) {
+			executor->join(result);
+		}
+		return nullptr;
+	});
+	root.set_thread_safe();
+
+	double single = 0;
+	for (size_t workers = 1; workers <= std::max(std::thread::hardware_concurrency(), 1u); workers++) {
+		Executor executor(workers);
+
+		auto start = std::chrono::steady_clock::now();
+		std::vector<std::future<Ref<Object>>> results;
+		for (size_t i = 0; i < roots; i++) {
+			results.push_back(executor.submit(root, {}));
+		}
+		for (auto& result : results) {
+			result.get();  // without helping, so that only the workers run tasks.
+		}
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		if (workers == 1) {
+			single = elapsed.count();
+		}
+		std::cout << "executor, " << workers << " workers: " << elapsed.count() << " ms (x" << single / elapsed.count() << ")\n";
+	}
+}
+
 int main()
 {
 	using namespace Silicon;
@@ -21,5 +107,8 @@ int main()
 
 	std::cout << "instance check" << Object::typeObject->instance_check(object_type) << '\n';
 
+	bench_typecheck_args(100000);
+	bench_executor_scaling(64, 32);
+
 	std::cout << "end\n";
 }
@@ -86,6 +86,13 @@ namespace inthandling {
 	inline constexpr T max(T i1, T i2) {
 		return i1 > i2 ? i1 : i2;
 	}
+
+	// round i up to the next multiple of align.
+	template<class T>
+	requires std::unsigned_integral<T>
+	inline constexpr T align_up(T i, T align) {
+		return (i + align - 1) / align * align;
+	}
 			
 }
 